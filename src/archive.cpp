@@ -9,6 +9,7 @@
 */
 
 #include "archive.h"
+#include "archive_bin.h"
 #include "archive_txt.h"
 #include "archive_zip.h"
 #include "file_handle.h"
@@ -23,8 +24,12 @@ Archive::Formats Archive::formatOf(const char* path) {
 
 	File* file = File::create();
 	if (file->open(path, Stream::READ)) {
+		constexpr const size_t MAGIC_SIZE = BITTY_COUNTOF(ARCHIVE_PACKED_MAGIC) - 1;
+		Byte magic[MAGIC_SIZE];
 		std::string ln;
-		if (file->readLine(ln)) {
+		if (file->readBytes(magic, MAGIC_SIZE) == MAGIC_SIZE && memcmp(magic, ARCHIVE_PACKED_MAGIC, MAGIC_SIZE) == 0) {
+			result = BIN;
+		} else if (file->poke(0) && file->readLine(ln)) {
 			if (ln == ARCHIVE_PACKAGE_MEDIA_HEAD ":" ARCHIVE_ARCHIVE_MEDIA_TYPE ";")
 				result = TXT;
 		}
@@ -41,6 +46,8 @@ Archive* Archive::create(Formats type) {
 		return archive_create_txt();
 	case ZIP:
 		return archive_create_zip();
+	case BIN:
+		return archive_create_bin();
 	default:
 		assert(false && "Unknown.");
 
@@ -58,6 +65,10 @@ void Archive::destroy(Archive* ptr) {
 	case ZIP:
 		archive_destroy_zip(ptr);
 
+		break;
+	case BIN:
+		archive_destroy_bin(ptr);
+
 		break;
 	default:
 		assert(false && "Unknown.");
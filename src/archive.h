@@ -40,7 +40,8 @@ public:
 
 	enum Formats : unsigned {
 		TXT,
-		ZIP
+		ZIP,
+		BIN
 	};
 
 public:
@@ -68,6 +69,18 @@ public:
 	virtual bool renamable(void) const = 0;
 	virtual bool rename(const char* nameInArchive, const char* newNameInArchive) = 0;
 
+	/**
+	 * @brief Gets a zero-copy view of an entry stored verbatim in a read-only
+	 *   archive.
+	 *
+	 * @note Read-only archives keep the file mapped till closed, the file must
+	 *   not be written by another archive or stream meanwhile.
+	 *
+	 * @param[out] data Valid until the archive is closed.
+	 * @param[out] len
+	 * @return `false` if the entry is compressed or encoded, use `toBytes` instead.
+	 */
+	virtual bool view(const Byte** data, size_t* len, const char* nameInArchive) const = 0;
 	/**
 	 * @param[out] val
 	 */
@@ -0,0 +1,756 @@
+/*
+** Bitty
+**
+** An itty bitty game engine.
+**
+** Copyright (C) 2020 - 2025 Tony Wang, all rights reserved
+**
+** For the latest info, see https://github.com/paladin-t/bitty/
+*/
+
+#include "archive_bin.h"
+#include "bytes.h"
+#include "encoding.h"
+#include "file_handle.h"
+#include "filesystem.h"
+#include "../lib/lz4/lib/lz4.h"
+#include "../lib/zlib/zlib.h"
+
+/*
+** {===========================================================================
+** Macros and constants
+*/
+
+#ifndef ARCHIVE_PACKED_VERSION
+#	define ARCHIVE_PACKED_VERSION 1
+#endif /* ARCHIVE_PACKED_VERSION */
+
+#ifndef ARCHIVE_PACKED_HEADER_SIZE
+#	define ARCHIVE_PACKED_HEADER_SIZE 32
+#endif /* ARCHIVE_PACKED_HEADER_SIZE */
+
+#ifndef ARCHIVE_PACKED_ALIGNMENT
+#	define ARCHIVE_PACKED_ALIGNMENT 4096
+#endif /* ARCHIVE_PACKED_ALIGNMENT */
+
+#ifndef ARCHIVE_PACKED_COMPRESS_MIN_SIZE
+#	define ARCHIVE_PACKED_COMPRESS_MIN_SIZE 256
+#endif /* ARCHIVE_PACKED_COMPRESS_MIN_SIZE */
+
+/* ===========================================================================} */
+
+/*
+** {===========================================================================
+** Packed archive
+**
+** @note Layout, all integers in little-endian:
+**   header: magic (8 bytes), version (UInt32), entry count (UInt32),
+**     TOC offset (UInt64), TOC size (UInt64);
+**   payloads: each begins at a multiple of `ARCHIVE_PACKED_ALIGNMENT`;
+**   TOC: per entry in insertion order, name hash (UInt64), payload offset
+**     (UInt64), payload size (UInt64), raw size (UInt64), codec (UInt32),
+**     CRC32 of the payload (UInt32), name length (UInt32), name.
+**
+** @note Removed or replaced payloads and superseded TOCs are left as holes,
+**   the file is compacted on closing once the holes take up more than the
+**   live data.
+*/
+
+class ArchiveImplBin : public Archive {
+private:
+	struct Entry {
+		typedef std::vector<Entry> Array;
+
+		enum Codecs : UInt32 {
+			NONE,
+			LZ4
+		};
+
+		std::string name;
+		UInt64 hash = 0;
+		UInt64 offset = 0;
+		UInt64 size = 0;
+		UInt64 rawSize = 0;
+		UInt32 codec = NONE;
+		UInt32 checksum = 0;
+	};
+	typedef std::vector<size_t> EntryIndex;
+
+private:
+	Stream::Accesses _accessibility = Stream::READ_WRITE;
+	bool _forWriting = true;
+
+	std::string _file;
+	MappedFile* _mapping = nullptr; // Kept mapped for the archive's lifetime when reading.
+	File* _writer = nullptr; // Kept open for the archive's lifetime when writing.
+	UInt64 _end = 0; // Where the next payload goes.
+	bool _dirty = false;
+
+	Entry::Array _entries;
+	EntryIndex _index; // Sorted by name hash.
+
+public:
+	ArchiveImplBin() {
+	}
+	virtual ~ArchiveImplBin() override {
+		close();
+	}
+
+	virtual unsigned type(void) const override {
+		return TYPE();
+	}
+
+	virtual bool open(const char* path, Stream::Accesses access) override {
+		close();
+
+		if (!path)
+			return false;
+
+		_accessibility = access;
+		_forWriting = access == Stream::WRITE || access == Stream::APPEND || access == Stream::READ_WRITE;
+		_file = path;
+
+		bool opened = false;
+		if (_forWriting) {
+			bool existing = false;
+			UInt64 tocEnd = 0;
+			if (access != Stream::WRITE && Path::existsFile(_file.c_str())) {
+				MappedFile* mapping = MappedFile::create();
+				if (mapping->open(_file.c_str()) && mapping->count()) {
+					if (!getEntries(mapping, _entries, &tocEnd)) { // Do not append to a file in other format.
+						MappedFile::destroy(mapping);
+						_entries.clear();
+
+						return false;
+					}
+					existing = true;
+				}
+				MappedFile::destroy(mapping);
+			}
+			if (!existing && access == Stream::READ_WRITE)
+				return false;
+
+			_writer = File::create();
+			opened = _writer->open(_file.c_str(), existing ? Stream::READ_WRITE : Stream::WRITE);
+			if (!opened) {
+				File::destroy(_writer);
+				_writer = nullptr;
+				_entries.clear();
+
+				return false;
+			}
+
+			_end = align(std::max((UInt64)ARCHIVE_PACKED_HEADER_SIZE, tocEnd)); // Keep the old TOC intact until the header is rewritten.
+			for (const Entry &ent : _entries)
+				_end = std::max(_end, align(ent.offset + ent.size));
+			_dirty = !existing; // Make sure a new file gets a valid header.
+		} else {
+			_mapping = MappedFile::create();
+			opened = _mapping->open(_file.c_str()) && getEntries(_mapping, _entries, nullptr);
+			if (!opened) {
+				MappedFile::destroy(_mapping);
+				_mapping = nullptr;
+				_entries.clear();
+			}
+		}
+		index();
+
+		return opened;
+	}
+	virtual bool close(void) override {
+		bool result = false;
+
+		if (_writer) {
+			if (_dirty) {
+				if (wasteful())
+					compact();
+				putEntries(_writer);
+			}
+			_writer->close();
+			File::destroy(_writer);
+			_writer = nullptr;
+
+			result = true;
+		}
+		if (_mapping) {
+			_mapping->close();
+			MappedFile::destroy(_mapping);
+			_mapping = nullptr;
+
+			result = true;
+		}
+
+		_accessibility = Stream::READ_WRITE;
+		_forWriting = true;
+
+		_file.clear();
+		_end = 0;
+		_dirty = false;
+
+		_entries.clear();
+		_index.clear();
+
+		return result;
+	}
+
+	virtual Formats format(void) const override {
+		return BIN;
+	}
+
+	virtual Stream::Accesses accessibility(void) const override {
+		return _accessibility;
+	}
+
+	virtual const char* password(void) const override {
+		return nullptr;
+	}
+	virtual bool password(const char*) override {
+		return false;
+	}
+
+	virtual bool all(Text::Array &entries) const override {
+		entries.clear();
+
+		if (_forWriting)
+			return false;
+
+		for (const Entry &ent : _entries)
+			entries.push_back(ent.name);
+
+		return true;
+	}
+
+	virtual bool exists(const char* nameInArchive) const override {
+		if (_forWriting)
+			return false;
+
+		return !!findEntry(nameInArchive);
+	}
+	virtual bool make(const char* nameInArchive) override {
+		if (!_forWriting)
+			return false;
+
+		if (!_writer)
+			return false;
+
+		if (findEntry(nameInArchive))
+			return false;
+
+		Entry ent;
+		ent.name = nameInArchive;
+		ent.hash = hash(nameInArchive);
+		ent.offset = _end;
+		ent.checksum = (UInt32)crc32(0L, Z_NULL, 0);
+		_entries.push_back(ent);
+		index();
+
+		_dirty = true;
+
+		return true;
+	}
+	virtual bool removable(void) const override {
+		return true;
+	}
+	virtual bool remove(const char* nameInArchive) override {
+		if (!_forWriting)
+			return false;
+
+		const Entry* ent = findEntry(nameInArchive);
+		if (!ent)
+			return false;
+
+		_entries.erase(_entries.begin() + (ent - &_entries.front())); // The payload is left as a hole until compacted.
+		index();
+
+		_dirty = true;
+
+		return true;
+	}
+	virtual bool renamable(void) const override {
+		return false;
+	}
+	virtual bool rename(const char* /* nameInArchive */, const char* /* newNameInArchive */) override {
+		return false;
+	}
+
+	virtual bool view(const Byte** data, size_t* len, const char* nameInArchive) const override {
+		if (data)
+			*data = nullptr;
+		if (len)
+			*len = 0;
+
+		if (_forWriting)
+			return false;
+
+		if (!data || !len)
+			return false;
+
+		const Entry* ent = findEntry(nameInArchive);
+		if (!ent)
+			return false;
+
+		if (ent->codec != Entry::NONE)
+			return false;
+
+		return payload(data, len, *ent);
+	}
+	virtual bool toBytes(class Bytes* val, const char* nameInArchive) const override {
+		if (_forWriting)
+			return false;
+
+		if (!val)
+			return false;
+
+		val->clear();
+
+		const Entry* ent = findEntry(nameInArchive);
+		if (!ent)
+			return false;
+
+		const Byte* data = nullptr;
+		size_t len = 0;
+		if (!payload(&data, &len, *ent))
+			return false;
+
+		uLong crc = crc32(0L, Z_NULL, 0);
+		if (len)
+			crc = crc32(crc, (const Bytef*)data, (uInt)len);
+		if ((UInt32)crc != ent->checksum)
+			return false;
+
+		switch (ent->codec) {
+		case Entry::NONE:
+			if (len)
+				val->writeBytes(data, len);
+
+			break;
+		case Entry::LZ4:
+			val->resize((size_t)ent->rawSize);
+			if (ent->rawSize) {
+				const int n = LZ4_decompress_safe(
+					(const char*)data, (char*)val->pointer(),
+					(int)len, (int)val->count()
+				);
+				if (n < 0 || (UInt64)n != ent->rawSize) {
+					val->clear();
+
+					return false;
+				}
+			}
+
+			break;
+		default:
+			return false;
+		}
+
+		return true;
+	}
+	virtual bool fromBytes(const class Bytes* val, const char* nameInArchive) override {
+		if (!_forWriting)
+			return false;
+
+		if (!val || !nameInArchive)
+			return false;
+
+		if (!_writer)
+			return false;
+
+		Entry ent;
+		ent.name = nameInArchive;
+		ent.hash = hash(nameInArchive);
+		ent.offset = _end;
+		ent.rawSize = (UInt64)val->count();
+
+		Bytes* compressed = nullptr;
+		const Bytes* stored = val;
+		if (val->count() >= ARCHIVE_PACKED_COMPRESS_MIN_SIZE) {
+			compressed = Bytes::create();
+			if (Lz4::fromBytes(compressed, val) && compressed->count() * 8 < val->count() * 7) { // Keep it only if it saves enough.
+				ent.codec = Entry::LZ4;
+				stored = compressed;
+			}
+		}
+		ent.size = (UInt64)stored->count();
+		uLong crc = crc32(0L, Z_NULL, 0);
+		if (!stored->empty())
+			crc = crc32(crc, (const Bytef*)stored->pointer(), (uInt)stored->count());
+		ent.checksum = (UInt32)crc;
+
+		bool result = true;
+		if (!stored->empty()) {
+			result = _writer->poke((size_t)ent.offset) &&
+				_writer->writeBytes(stored->pointer(), stored->count()) == (int)stored->count();
+		}
+		if (compressed)
+			Bytes::destroy(compressed);
+		if (!result)
+			return false;
+
+		const Entry* old = findEntry(nameInArchive);
+		if (old)
+			_entries.erase(_entries.begin() + (old - &_entries.front()));
+		_entries.push_back(ent);
+		index();
+
+		_end = align(ent.offset + ent.size);
+		_dirty = true;
+
+		return true;
+	}
+
+	virtual bool toFile(const char* path, const char* nameInArchive) const override {
+		if (_forWriting)
+			return false;
+
+		if (!path)
+			return false;
+
+		bool result = false;
+
+		File* file = File::create();
+		Bytes* bytes = Bytes::create();
+		{
+			const Byte* data = nullptr;
+			size_t len = 0;
+			if (view(&data, &len, nameInArchive)) { // Write straight from the mapping.
+				if (file->open(path, Stream::WRITE)) {
+					if (len)
+						file->writeBytes(data, len);
+					file->close();
+
+					result = true;
+				}
+			} else if (toBytes(bytes, nameInArchive)) {
+				if (file->open(path, Stream::WRITE)) {
+					if (!bytes->empty())
+						file->writeBytes(bytes);
+					file->close();
+
+					result = true;
+				}
+			}
+		}
+		Bytes::destroy(bytes);
+		File::destroy(file);
+
+		return result;
+	}
+	virtual bool fromFile(const char* path, const char* nameInArchive) override {
+		if (!_forWriting)
+			return false;
+
+		if (!path)
+			return false;
+
+		bool result = false;
+
+		File* file = File::create();
+		Bytes* bytes = Bytes::create();
+		{
+			if (file->open(path, Stream::READ)) {
+				size_t l = file->count();
+				if (l > 0)
+					file->readBytes(bytes);
+				file->close();
+
+				result = fromBytes(bytes, nameInArchive);
+			}
+		}
+		Bytes::destroy(bytes);
+		File::destroy(file);
+
+		return result;
+	}
+
+	virtual bool toDirectory(const char* dir) const override {
+		if (_forWriting)
+			return false;
+
+		if (!dir)
+			return false;
+
+		for (const Entry &ent : _entries) {
+			std::string sfile = dir;
+			if (sfile.back() != '/' && sfile.back() != '\\')
+				sfile += "/";
+			sfile += ent.name;
+
+			FileInfo::Ptr fileInfo = FileInfo::make(sfile.c_str());
+			DirectoryInfo::Ptr dirInfo = DirectoryInfo::make(fileInfo->parentPath().c_str());
+			if (!dirInfo->exists())
+				Path::touchDirectory(dirInfo->fullPath().c_str());
+
+			toFile(sfile.c_str(), ent.name.c_str());
+		}
+
+		return true;
+	}
+	virtual bool fromDirectory(const char* dir) override {
+		if (!_forWriting)
+			return false;
+
+		if (!dir)
+			return false;
+
+		DirectoryInfo::Ptr dirInfo = DirectoryInfo::make(dir);
+		if (!dirInfo->exists())
+			return false;
+
+		std::function<void(DirectoryInfo::Ptr, const std::string &)> pack;
+		pack = [this, &pack] (DirectoryInfo::Ptr dirInfo, const std::string &root) -> void {
+			FileInfos::Ptr fileInfos = dirInfo->getFiles("*;*.*", false);
+			IEnumerator::Ptr enumerator = fileInfos->enumerate();
+			while (enumerator->next()) {
+				Variant::Pair pair = enumerator->current();
+				Object::Ptr val = (Object::Ptr)pair.second;
+				if (!val)
+					continue;
+				FileInfo::Ptr fileInfo = Object::as<FileInfo::Ptr>(val);
+				if (!fileInfo)
+					continue;
+
+				std::string filePath = fileInfo->fileName();
+				if (!fileInfo->extName().empty()) {
+					filePath += ".";
+					filePath += fileInfo->extName();
+				}
+				filePath = Path::combine(root.c_str(), filePath.c_str());
+				fromFile(fileInfo->fullPath().c_str(), filePath.c_str());
+			}
+
+			DirectoryInfos::Ptr dirInfos = dirInfo->getDirectories(false);
+			enumerator = dirInfos->enumerate();
+			while (enumerator->next()) {
+				Variant::Pair pair = enumerator->current();
+				Object::Ptr val = (Object::Ptr)pair.second;
+				if (!val)
+					continue;
+				DirectoryInfo::Ptr subDirInfo = Object::as<DirectoryInfo::Ptr>(val);
+				if (!subDirInfo)
+					continue;
+
+				const std::string subDir = Path::combine(root.c_str(), subDirInfo->dirName().c_str());
+				pack(subDirInfo, subDir);
+			}
+		};
+
+		pack(dirInfo, "");
+
+		return true;
+	}
+
+private:
+	const Entry* findEntry(const char* name) const {
+		if (!name)
+			return nullptr;
+
+		const UInt64 h = hash(name);
+		EntryIndex::const_iterator it = std::lower_bound(
+			_index.begin(), _index.end(), h,
+			[this] (size_t idx, UInt64 h) -> bool {
+				return _entries[idx].hash < h;
+			}
+		);
+		for ( ; it != _index.end() && _entries[*it].hash == h; ++it) { // Resolve collisions by name.
+			const Entry &ent = _entries[*it];
+			if (ent.name == name)
+				return &ent;
+		}
+
+		return nullptr;
+	}
+	void index(void) {
+		_index.resize(_entries.size());
+		for (size_t i = 0; i < _entries.size(); ++i)
+			_index[i] = i;
+		std::stable_sort(
+			_index.begin(), _index.end(),
+			[this] (size_t left, size_t right) -> bool {
+				return _entries[left].hash < _entries[right].hash;
+			}
+		);
+	}
+	bool payload(const Byte** data, size_t* len, const Entry &entry) const {
+		if (!_mapping)
+			return false;
+
+		if (entry.offset > _mapping->count() || entry.size > _mapping->count() - entry.offset)
+			return false;
+
+		*data = entry.size ? _mapping->pointer() + entry.offset : nullptr;
+		*len = (size_t)entry.size;
+
+		return true;
+	}
+
+	bool wasteful(void) const {
+		UInt64 live = align(ARCHIVE_PACKED_HEADER_SIZE);
+		for (const Entry &ent : _entries)
+			live += align(ent.size);
+
+		return live * 2 < _end;
+	}
+	bool compact(void) {
+		// Read the live payloads back before truncating.
+		std::vector<Bytes::Ptr> payloads;
+		payloads.reserve(_entries.size());
+		for (const Entry &ent : _entries) {
+			Bytes::Ptr buf(Bytes::create());
+			if (ent.size) {
+				if (!_writer->poke((size_t)ent.offset) || _writer->readBytes(buf.get(), (size_t)ent.size) != (size_t)ent.size)
+					return false;
+			}
+			payloads.push_back(buf);
+		}
+
+		// Rewrite them contiguously in the same order.
+		_writer->close();
+		if (!_writer->open(_file.c_str(), Stream::WRITE))
+			return false;
+
+		_end = align(ARCHIVE_PACKED_HEADER_SIZE);
+		for (size_t i = 0; i < _entries.size(); ++i) {
+			Entry &ent = _entries[i];
+			const Bytes::Ptr &buf = payloads[i];
+			ent.offset = _end;
+			if (!buf->empty()) {
+				if (!_writer->poke((size_t)ent.offset) || _writer->writeBytes(buf.get()) != (int)buf->count())
+					return false;
+			}
+			_end = align(ent.offset + ent.size);
+		}
+
+		return true;
+	}
+
+	bool getEntries(const MappedFile* mapping, Entry::Array &entries, UInt64* tocEnd /* nullable */) const {
+		entries.clear();
+
+		const Byte* begin = mapping->pointer();
+		const size_t count = mapping->count();
+		if (!begin || count < ARCHIVE_PACKED_HEADER_SIZE)
+			return false;
+
+		if (memcmp(begin, ARCHIVE_PACKED_MAGIC, BITTY_COUNTOF(ARCHIVE_PACKED_MAGIC) - 1) != 0)
+			return false;
+
+		const Byte* cursor = begin + BITTY_COUNTOF(ARCHIVE_PACKED_MAGIC) - 1;
+		const Byte* end = begin + ARCHIVE_PACKED_HEADER_SIZE;
+		UInt32 version = 0;
+		UInt32 n = 0;
+		UInt64 tocOffset = 0;
+		UInt64 tocSize = 0;
+		if (!read(cursor, end, version) || !read(cursor, end, n) || !read(cursor, end, tocOffset) || !read(cursor, end, tocSize))
+			return false;
+		if (version > ARCHIVE_PACKED_VERSION)
+			return false;
+		if (tocOffset > count || tocSize > count - tocOffset)
+			return false;
+		if (tocEnd)
+			*tocEnd = tocOffset + tocSize;
+
+		cursor = begin + tocOffset;
+		end = cursor + tocSize;
+		entries.reserve(n);
+		for (UInt32 i = 0; i < n; ++i) {
+			Entry ent;
+			UInt32 l = 0;
+			if (
+				!read(cursor, end, ent.hash) || !read(cursor, end, ent.offset) ||
+				!read(cursor, end, ent.size) || !read(cursor, end, ent.rawSize) ||
+				!read(cursor, end, ent.codec) || !read(cursor, end, ent.checksum) ||
+				!read(cursor, end, l) || l > (size_t)(end - cursor)
+			) {
+				entries.clear();
+
+				return false;
+			}
+			ent.name.assign((const char*)cursor, l);
+			cursor += l;
+
+			entries.push_back(ent);
+		}
+
+		return true;
+	}
+	bool putEntries(File* file) {
+		Bytes* toc = Bytes::create();
+		for (const Entry &ent : _entries) {
+			toc->writeUInt64(ent.hash);
+			toc->writeUInt64(ent.offset);
+			toc->writeUInt64(ent.size);
+			toc->writeUInt64(ent.rawSize);
+			toc->writeUInt32(ent.codec);
+			toc->writeUInt32(ent.checksum);
+			toc->writeUInt32((UInt32)ent.name.length());
+			toc->writeBytes((const Byte*)ent.name.c_str(), ent.name.length());
+		}
+
+		Byte header[ARCHIVE_PACKED_HEADER_SIZE];
+		memset(header, 0, sizeof(header));
+		Byte* cursor = header;
+		write(cursor, ARCHIVE_PACKED_MAGIC, BITTY_COUNTOF(ARCHIVE_PACKED_MAGIC) - 1);
+		const UInt32 version = ARCHIVE_PACKED_VERSION;
+		const UInt32 n = (UInt32)_entries.size();
+		const UInt64 tocOffset = _end;
+		const UInt64 tocSize = (UInt64)toc->count();
+		write(cursor, &version, sizeof(version));
+		write(cursor, &n, sizeof(n));
+		write(cursor, &tocOffset, sizeof(tocOffset));
+		write(cursor, &tocSize, sizeof(tocSize));
+
+		bool result = true;
+		if (!toc->empty()) {
+			result = file->poke((size_t)tocOffset) &&
+				file->writeBytes(toc) == (int)toc->count();
+		}
+		Bytes::destroy(toc);
+		if (!result)
+			return false;
+
+		result = file->poke(0) &&
+			file->writeBytes(header, sizeof(header)) == (int)sizeof(header);
+
+		return result;
+	}
+
+	template<typename T> static bool read(const Byte* &cursor, const Byte* end, T &val) {
+		if ((size_t)(end - cursor) < sizeof(T))
+			return false;
+
+		memcpy(&val, cursor, sizeof(T));
+		cursor += sizeof(T);
+
+		return true;
+	}
+	static void write(Byte* &cursor, const void* val, size_t len) {
+		memcpy(cursor, val, len);
+		cursor += len;
+	}
+
+	static UInt64 align(UInt64 pos) {
+		return (pos + ARCHIVE_PACKED_ALIGNMENT - 1) / ARCHIVE_PACKED_ALIGNMENT * ARCHIVE_PACKED_ALIGNMENT;
+	}
+	static UInt64 hash(const char* name) {
+		UInt64 result = 14695981039346656037ull; // FNV-1a.
+		for (const char* ch = name; *ch; ++ch) {
+			result ^= (UInt64)(Byte)*ch;
+			result *= 1099511628211ull;
+		}
+
+		return result;
+	}
+};
+
+Archive* archive_create_bin(void) {
+	ArchiveImplBin* result = new ArchiveImplBin();
+
+	return result;
+}
+
+void archive_destroy_bin(Archive* ptr) {
+	ArchiveImplBin* impl = static_cast<ArchiveImplBin*>(ptr);
+	delete impl;
+}
+
+/* ===========================================================================} */
@@ -0,0 +1,37 @@
+/*
+** Bitty
+**
+** An itty bitty game engine.
+**
+** Copyright (C) 2020 - 2025 Tony Wang, all rights reserved
+**
+** For the latest info, see https://github.com/paladin-t/bitty/
+*/
+
+#ifndef __ARCHIVE_BIN_H__
+#define __ARCHIVE_BIN_H__
+
+#include "archive.h"
+
+/*
+** {===========================================================================
+** Macros and constants
+*/
+
+#ifndef ARCHIVE_PACKED_MAGIC
+#	define ARCHIVE_PACKED_MAGIC "BITTYPAK"
+#endif /* ARCHIVE_PACKED_MAGIC */
+
+/* ===========================================================================} */
+
+/*
+** {===========================================================================
+** Packed archive
+*/
+
+class Archive* archive_create_bin(void);
+void archive_destroy_bin(class Archive* ptr);
+
+/* ===========================================================================} */
+
+#endif /* __ARCHIVE_BIN_H__ */
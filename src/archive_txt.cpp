@@ -13,6 +13,7 @@
 #include "encoding.h"
 #include "file_handle.h"
 #include "filesystem.h"
+#include <unordered_map>
 
 /*
 ** {===========================================================================
@@ -141,14 +142,17 @@ private:
 
 		const static decltype(std::string::npos) npos;
 	};
+	typedef std::unordered_map<std::string, Entry::List::iterator> EntryIndex;
 
 private:
 	Stream::Accesses _accessibility = Stream::READ_WRITE;
 	bool _forWriting = true;
 
 	std::string _file;
+	MappedFile* _mapping = nullptr; // Kept mapped for the archive's lifetime when reading.
 
 	Entry::List _entries;
+	EntryIndex _index; // By path.
 
 public:
 	ArchiveImplTxt() {
@@ -193,11 +197,35 @@ public:
 		} else {
 			opened = file->open(_file.c_str(), Stream::READ);
 		}
-		if (opened)
+		if (opened && !_forWriting) {
+			getEntries(file, _entries);
 			file->close();
+		} else {
+			if (opened)
+				file->close();
+			File::destroy(file);
+
+			file = File::create();
+			if (file->open(_file.c_str(), Stream::READ)) {
+				getEntries(file, _entries);
+				file->close();
+			}
+		}
 		File::destroy(file);
 
-		getEntries(_entries);
+		if (opened && !_forWriting) { // Bodies are read from the mapping directly.
+			_mapping = MappedFile::create();
+			if (!_mapping->open(_file.c_str())) {
+				MappedFile::destroy(_mapping);
+				_mapping = nullptr;
+				_entries.clear();
+
+				opened = false;
+			}
+		}
+		_index.clear();
+		for (Entry::List::iterator it = _entries.begin(); it != _entries.end(); ++it)
+			_index[it->path] = it;
 
 		return opened;
 	}
@@ -206,8 +234,14 @@ public:
 		_forWriting = true;
 
 		_file.clear();
+		if (_mapping) {
+			_mapping->close();
+			MappedFile::destroy(_mapping);
+			_mapping = nullptr;
+		}
 
 		_entries.clear();
+		_index.clear();
 
 		return true;
 	}
@@ -280,6 +314,27 @@ public:
 		return false;
 	}
 
+	virtual bool view(const Byte** data, size_t* len, const char* nameInArchive) const override {
+		if (data)
+			*data = nullptr;
+		if (len)
+			*len = 0;
+
+		if (_forWriting)
+			return false;
+
+		if (!data || !len)
+			return false;
+
+		Entry ent;
+		if (!findEntry(ent, nameInArchive))
+			return false;
+
+		if (!ent.encoding.empty()) // Encoded body.
+			return false;
+
+		return body(data, len, ent);
+	}
 	virtual bool toBytes(class Bytes* val, const char* nameInArchive) const override {
 		if (_forWriting)
 			return false;
@@ -293,21 +348,16 @@ public:
 		if (!findEntry(ent, nameInArchive))
 			return false;
 
-		File* file = File::create();
-		if (file->open(_file.c_str(), Stream::READ)) {
-			file->poke(ent.body);
-			file->readBytes(val, ent.count);
-			file->readLine();
-			if (ent.encoding == ARCHIVE_BASE64_MEDIA_ENCODING) {
-				std::string str;
-				str.assign((const char*)val->pointer(), val->count());
-				val->clear();
-				Base64::toBytes(val, str);
-			}
+		const Byte* data = nullptr;
+		size_t len = 0;
+		if (!body(&data, &len, ent))
+			return false;
 
-			file->close();
-		}
-		File::destroy(file);
+		if (len)
+			val->writeBytes(data, len);
+		val->poke(0);
+		if (ent.encoding == ARCHIVE_BASE64_MEDIA_ENCODING)
+			Base64::toBytes(val); // In place.
 
 		return true;
 	}
@@ -354,7 +404,17 @@ public:
 		File* file = File::create();
 		Bytes* bytes = Bytes::create();
 		{
-			if (toBytes(bytes, nameInArchive)) {
+			const Byte* data = nullptr;
+			size_t len = 0;
+			if (view(&data, &len, nameInArchive)) { // Write straight from the mapping.
+				if (file->open(path, Stream::WRITE)) {
+					if (len)
+						file->writeBytes(data, len);
+					file->close();
+
+					result = true;
+				}
+			} else if (toBytes(bytes, nameInArchive)) {
 				if (file->open(path, Stream::WRITE)) {
 					if (!bytes->empty())
 						file->writeBytes(bytes);
@@ -405,29 +465,19 @@ public:
 		if (!dir)
 			return false;
 
-		File* file = File::create();
-		Bytes* bytes = Bytes::create();
 		for (const Entry &ent : _entries) {
 			std::string sfile = dir;
 			if (sfile.back() != '/' && sfile.back() != '\\')
 				sfile += "/";
 			sfile += ent.path;
 
-			bytes->clear();
-			toBytes(bytes, ent.path.c_str());
-
 			FileInfo::Ptr fileInfo = FileInfo::make(sfile.c_str());
 			DirectoryInfo::Ptr dirInfo = DirectoryInfo::make(fileInfo->parentPath().c_str());
 			if (!dirInfo->exists())
 				Path::touchDirectory(dirInfo->fullPath().c_str());
 
-			file->open(sfile.c_str(), Stream::WRITE);
-			if (!bytes->empty())
-				file->writeBytes(bytes);
-			file->close();
+			toFile(sfile.c_str(), ent.path.c_str());
 		}
-		Bytes::destroy(bytes);
-		File::destroy(file);
 
 		return true;
 	}
@@ -486,7 +536,7 @@ public:
 	}
 
 private:
-	bool getEntries(Entry::List &entries) const {
+	bool getEntries(File* file, Entry::List &entries) const {
 		auto ignoreBlank = [] (File* file) -> void {
 			while (!file->endOfStream()) {
 				const size_t p = file->peek();
@@ -511,11 +561,7 @@ private:
 
 		entries.clear();
 
-		File* file = File::create();
 		do {
-			if (!file->open(_file.c_str(), Stream::READ))
-				break;
-
 			std::string ln;
 			if (!file->readLine(ln) || ln != ARCHIVE_PACKAGE_MEDIA_HEAD ":" ARCHIVE_ARCHIVE_MEDIA_TYPE ";")
 				break;
@@ -606,24 +652,34 @@ private:
 				ignoreBlank(file);
 			}
 
-			file->close();
-
 			result = true;
 		} while (false);
-		File::destroy(file);
 
 		return result;
 	}
 	bool findEntry(Entry &entry, const char* path) const {
-		for (const Entry &ent : _entries) {
-			if (ent.path == path) {
-				entry = ent;
+		if (!path)
+			return false;
 
-				return true;
-			}
-		}
+		EntryIndex::const_iterator it = _index.find(path);
+		if (it == _index.end())
+			return false;
 
-		return false;
+		entry = *it->second;
+
+		return true;
+	}
+	bool body(const Byte** data, size_t* len, const Entry &entry) const {
+		if (!_mapping)
+			return false;
+
+		if (entry.body == Entry::npos || entry.body + entry.count > _mapping->count())
+			return false;
+
+		*data = entry.count ? _mapping->pointer() + entry.body : nullptr;
+		*len = entry.count;
+
+		return true;
 	}
 	bool makeEntry(const Entry &entry, const Bytes* val) {
 		Entry ent;
@@ -677,7 +733,8 @@ private:
 
 		if (result) {
 			_entries.push_back(ent);
-			_entries.sort(
+			_index[ent.path] = --_entries.end();
+			_entries.sort( // Keeps iterators valid.
 				[] (const Entry &left, const Entry &right) -> bool {
 					return left.path < right.path;
 				}
@@ -723,6 +780,7 @@ private:
 		File::destroy(file);
 
 		if (result) {
+			_index.erase(entry.path);
 			_entries.remove_if(
 				[&] (const Entry &ent) -> bool {
 					return ent.path == entry.path;
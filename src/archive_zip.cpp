@@ -31,6 +31,83 @@
 
 /* ===========================================================================} */
 
+/*
+** {===========================================================================
+** Utilities
+*/
+
+/**
+ * @brief Read cursor over a mapped archive, for minizip's I/O callbacks.
+ */
+struct ArchiveZipMappedStream {
+	const Byte* data = nullptr;
+	size_t size = 0;
+	size_t position = 0;
+};
+
+static voidpf ZCALLBACK archiveZipMappedOpen(voidpf opaque, const void* /* filename */, int mode) {
+	if ((mode & ZLIB_FILEFUNC_MODE_READWRITEFILTER) != ZLIB_FILEFUNC_MODE_READ)
+		return nullptr;
+
+	const MappedFile* mapping = (const MappedFile*)opaque;
+	ArchiveZipMappedStream* stream = new ArchiveZipMappedStream();
+	stream->data = mapping->pointer();
+	stream->size = mapping->count();
+
+	return stream;
+}
+
+static uLong ZCALLBACK archiveZipMappedRead(voidpf /* opaque */, voidpf stream, void* buf, uLong size) {
+	ArchiveZipMappedStream* s = (ArchiveZipMappedStream*)stream;
+	const size_t len = std::min((size_t)size, s->size - s->position);
+	if (len) {
+		memcpy(buf, s->data + s->position, len);
+		s->position += len;
+	}
+
+	return (uLong)len;
+}
+
+static uLong ZCALLBACK archiveZipMappedWrite(voidpf /* opaque */, voidpf /* stream */, const void* /* buf */, uLong /* size */) {
+	return 0;
+}
+
+static ZPOS64_T ZCALLBACK archiveZipMappedTell(voidpf /* opaque */, voidpf stream) {
+	const ArchiveZipMappedStream* s = (const ArchiveZipMappedStream*)stream;
+
+	return (ZPOS64_T)s->position;
+}
+
+static long ZCALLBACK archiveZipMappedSeek(voidpf /* opaque */, voidpf stream, ZPOS64_T offset, int origin) {
+	ArchiveZipMappedStream* s = (ArchiveZipMappedStream*)stream;
+	ZPOS64_T pos = 0;
+	switch (origin) {
+	case ZLIB_FILEFUNC_SEEK_SET: pos = offset; break;
+	case ZLIB_FILEFUNC_SEEK_CUR: pos = s->position + offset; break;
+	case ZLIB_FILEFUNC_SEEK_END: pos = s->size + offset; break;
+	default: return -1;
+	}
+	if (pos > s->size)
+		return -1;
+
+	s->position = (size_t)pos;
+
+	return 0;
+}
+
+static int ZCALLBACK archiveZipMappedClose(voidpf /* opaque */, voidpf stream) {
+	ArchiveZipMappedStream* s = (ArchiveZipMappedStream*)stream;
+	delete s;
+
+	return 0;
+}
+
+static int ZCALLBACK archiveZipMappedError(voidpf /* opaque */, voidpf /* stream */) {
+	return 0;
+}
+
+/* ===========================================================================} */
+
 /*
 ** {===========================================================================
 ** ZIP archive
@@ -43,6 +120,7 @@ private:
 
 	zipFile _zipFile = nullptr;
 	unzFile _unzipFile = nullptr;
+	MappedFile* _mapping = nullptr; // Kept mapped for the archive's lifetime when reading.
 
 	std::string _file;
 	std::string _pwd;
@@ -91,7 +169,13 @@ public:
 
 			return !!_zipFile;
 		} else {
-			_unzipFile = unzOpen64(osstr.c_str());
+			_mapping = MappedFile::create();
+			if (!_mapping->open(_file.c_str())) {
+				MappedFile::destroy(_mapping);
+				_mapping = nullptr;
+			}
+
+			_unzipFile = openUnzip();
 
 			return !!_unzipFile;
 		}
@@ -114,6 +198,11 @@ public:
 			unzClose(_unzipFile);
 			_unzipFile = nullptr;
 		}
+		if (_mapping) {
+			_mapping->close();
+			MappedFile::destroy(_mapping);
+			_mapping = nullptr;
+		}
 
 		_file.clear();
 		_pwd.clear();
@@ -151,9 +240,7 @@ public:
 		if (_forWriting)
 			return false;
 
-		std::string osstr = Unicode::toOs(_file.c_str());
-
-		unzFile unzf = unzOpen64(osstr.c_str());
+		unzFile unzf = openUnzip();
 		if (!unzf)
 			return false;
 
@@ -231,6 +318,30 @@ public:
 		return false;
 	}
 
+	virtual bool view(const Byte** data, size_t* len, const char* nameInArchive) const override {
+		if (data)
+			*data = nullptr;
+		if (len)
+			*len = 0;
+
+		if (_forWriting)
+			return false;
+
+		if (!data || !len)
+			return false;
+
+		if (!_mapping || !_mapping->pointer())
+			return false;
+
+		// Keep the current entry of the shared handle intact.
+		unz64_file_pos cursor;
+		const bool restorable = unzGetFilePos64(_unzipFile, &cursor) == UNZ_OK;
+		const bool result = locate(data, len, nameInArchive);
+		if (restorable)
+			unzGoToFilePos64(_unzipFile, &cursor);
+
+		return result;
+	}
 	virtual bool toBytes(class Bytes* val, const char* nameInArchive) const override {
 		if (_forWriting)
 			return false;
@@ -240,6 +351,15 @@ public:
 
 		val->clear();
 
+		const Byte* data = nullptr;
+		size_t len = 0;
+		if (view(&data, &len, nameInArchive)) { // Stored entry, copy straight from the mapping.
+			if (len)
+				val->writeBytes(data, len);
+
+			return true;
+		}
+
 		int ret = 0;
 		unz_file_info64 unzFileInfo;
 		char file[BITTY_MAX_PATH];
@@ -314,7 +434,17 @@ public:
 		File* file = File::create();
 		Bytes* bytes = Bytes::create();
 		{
-			if (toBytes(bytes, nameInArchive)) {
+			const Byte* data = nullptr;
+			size_t len = 0;
+			if (view(&data, &len, nameInArchive)) { // Write straight from the mapping.
+				if (file->open(path, Stream::WRITE)) {
+					if (len)
+						file->writeBytes(data, len);
+					file->close();
+
+					result = true;
+				}
+			} else if (toBytes(bytes, nameInArchive)) {
 				if (file->open(path, Stream::WRITE)) {
 					if (!bytes->empty())
 						file->writeBytes(bytes);
@@ -460,6 +590,55 @@ public:
 
 		return true;
 	}
+
+private:
+	bool locate(const Byte** data, size_t* len, const char* nameInArchive) const {
+		if (nameInArchive) {
+			if (unzLocateFile(_unzipFile, nameInArchive, 1) != UNZ_OK)
+				return false;
+		}
+
+		unz_file_info64 unzFileInfo;
+		if (unzGetCurrentFileInfo64(_unzipFile, &unzFileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
+			return false;
+
+		if (unzFileInfo.compression_method != 0 || (unzFileInfo.flag & 1)) // Deflated or encrypted.
+			return false;
+		if (unzFileInfo.compressed_size != unzFileInfo.uncompressed_size)
+			return false;
+
+		if (unzOpenCurrentFile(_unzipFile) != UNZ_OK)
+			return false;
+		const ZPOS64_T pos = unzGetCurrentFileZStreamPos64(_unzipFile); // Where the raw data begins.
+		unzCloseCurrentFile(_unzipFile);
+
+		if (pos == 0 || pos + unzFileInfo.uncompressed_size > _mapping->count())
+			return false;
+
+		*data = _mapping->pointer() + pos;
+		*len = (size_t)unzFileInfo.uncompressed_size;
+
+		return true;
+	}
+	unzFile openUnzip(void) const {
+		if (_mapping && _mapping->pointer()) {
+			zlib_filefunc64_def funcs;
+			funcs.zopen64_file = archiveZipMappedOpen;
+			funcs.zread_file = archiveZipMappedRead;
+			funcs.zwrite_file = archiveZipMappedWrite;
+			funcs.ztell64_file = archiveZipMappedTell;
+			funcs.zseek64_file = archiveZipMappedSeek;
+			funcs.zclose_file = archiveZipMappedClose;
+			funcs.zerror_file = archiveZipMappedError;
+			funcs.opaque = (voidpf)_mapping;
+
+			return unzOpen2_64(_file.c_str(), &funcs);
+		}
+
+		const std::string osstr = Unicode::toOs(_file.c_str());
+
+		return unzOpen64(osstr.c_str());
+	}
 };
 
 Archive* archive_create_zip(void) {
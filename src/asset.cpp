@@ -35,6 +35,24 @@
 #include "sprite.h"
 #include "../lib/jpath/jpath.hpp"
 
+/*
+** {===========================================================================
+** Utilities
+*/
+
+static UInt64 assetHash(const class Bytes* buf) {
+	UInt64 result = 14695981039346656037ull; // FNV-1a.
+	const Byte* ptr = buf->pointer();
+	for (size_t i = 0; i < buf->count(); ++i) {
+		result ^= (UInt64)ptr[i];
+		result *= 1099511628211ull;
+	}
+
+	return result;
+}
+
+/* ===========================================================================} */
+
 /*
 ** {===========================================================================
 ** Asset
@@ -171,6 +189,8 @@ bool Asset::link(const char* package, const char* ent) {
 bool Asset::unlink(void) {
 	type(0);
 
+	_persisted = 0;
+
 	if (directoryInfo()) {
 		DirectoryInfo::destroy(directoryInfo());
 		directoryInfo(nullptr);
@@ -1102,6 +1122,13 @@ void Asset::dirty(bool val) {
 	}
 }
 
+bool Asset::persisted(const class Bytes* buf) const {
+	if (!_persisted || !buf)
+		return false;
+
+	return assetHash(buf) == _persisted;
+}
+
 std::string Asset::fullPath(void) const {
 	if (!fileInfo())
 		return "";
@@ -1285,10 +1312,14 @@ bool Asset::toBytes(class Bytes* buf) const {
 			return false;
 	}
 
+	_persisted = assetHash(buf);
+
 	return true;
 }
 
 bool Asset::fromBytes(class Bytes* buf) {
+	const UInt64 hash = assetHash(buf);
+
 	if (_project->loader()) {
 		if (!_project->loader()->encode(_project, this, buf))
 			return false;
@@ -1317,6 +1348,8 @@ bool Asset::fromBytes(class Bytes* buf) {
 		file->close();
 	}
 
+	_persisted = hash;
+
 	return true;
 }
 
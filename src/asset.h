@@ -119,6 +119,7 @@ public:
 
 private:
 	bool _dirty = false;
+	mutable UInt64 _persisted = 0; // Content hash of the bytes last read from or written to filesystem, 0 for unknown.
 	Usages _readyFor = NONE;
 
 	class Project* _project = nullptr; // Foreign.
@@ -248,6 +249,11 @@ public:
 	 * @brief Sets whether the asset contains unsaved modifications.
 	 */
 	void dirty(bool val);
+	/**
+	 * @brief Gets whether a specific buffer is identical to the content last read
+	 *   from or written to filesystem.
+	 */
+	bool persisted(const class Bytes* buf) const;
 
 	/**
 	 * @brief Gets the full path of the asset.
@@ -327,6 +327,9 @@
 #ifndef BITTY_ZIP_EXT
 #	define BITTY_ZIP_EXT "zip"
 #endif /* BITTY_ZIP_EXT */
+#ifndef BITTY_PACK_EXT
+#	define BITTY_PACK_EXT "pak"
+#endif /* BITTY_PACK_EXT */
 
 /* ===========================================================================} */
 
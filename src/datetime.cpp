@@ -15,6 +15,17 @@
 #	include <Windows.h>
 #endif /* BITTY_CP_VC */
 
+/*
+** {===========================================================================
+** Macros and constants
+*/
+
+#ifndef DATETIME_SPIN_WAIT_NANOSECONDS
+#	define DATETIME_SPIN_WAIT_NANOSECONDS 2000000ll /* 2 milliseconds. */
+#endif /* DATETIME_SPIN_WAIT_NANOSECONDS */
+
+/* ===========================================================================} */
+
 /*
 ** {===========================================================================
 ** Utilities
@@ -194,4 +205,16 @@ void DateTime::sleep(int ms) {
 	datetimeSleep(ms);
 }
 
+void DateTime::wait(long long t) {
+	if (t <= 0)
+		return;
+
+	const long long target = datetimeTicks() + t;
+	const long long coarse = t - DATETIME_SPIN_WAIT_NANOSECONDS;
+	if (coarse > 0)
+		datetimeSleep(toMilliseconds(coarse));
+	while (datetimeTicks() < target)
+		std::this_thread::yield();
+}
+
 /* ===========================================================================} */
@@ -105,6 +105,11 @@ public:
 	 * @brief Sleeps for specific milliseconds.
 	 */
 	static void sleep(int ms);
+	/**
+	 * @brief Waits for specific nanoseconds, sleeps coarsely then spins for
+	 *   the tail to be precise.
+	 */
+	static void wait(long long t);
 };
 
 /* ===========================================================================} */
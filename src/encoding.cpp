@@ -462,6 +462,49 @@ bool Base64::toBytes(class Bytes* val, const std::string &str) {
 	return true;
 }
 
+bool Base64::toBytes(class Bytes* val) {
+	constexpr const Byte INVALID = 0xff;
+	constexpr const Byte SKIPPED = 0xfe;
+	static const struct Table {
+		Byte values[256];
+
+		Table() {
+			constexpr const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+			memset(values, INVALID, sizeof(values));
+			for (int i = 0; i < 64; ++i)
+				values[(Byte)ALPHABET[i]] = (Byte)i;
+			values[(Byte)' '] = values[(Byte)'\t'] = values[(Byte)'\r'] = values[(Byte)'\n'] = SKIPPED;
+		}
+	} TABLE; // Thread-safe initialization.
+
+	// The output never overtakes the input, so it is safe to decode in place.
+	Byte* buf = val->pointer();
+	const size_t len = val->count();
+	size_t w = 0;
+	UInt32 acc = 0;
+	int bits = 0;
+	for (size_t r = 0; r < len; ++r) {
+		const Byte ch = buf[r];
+		if (ch == '=')
+			break;
+		const Byte v = TABLE.values[ch];
+		if (v == SKIPPED)
+			continue;
+		if (v == INVALID)
+			return false;
+
+		acc = (acc << 6) | v;
+		bits += 6;
+		if (bits >= 8) {
+			bits -= 8;
+			buf[w++] = (Byte)(acc >> bits);
+		}
+	}
+	val->resize(w);
+
+	return true;
+}
+
 bool Base64::fromBytes(std::string &val, const class Bytes* buf) {
 	val.clear();
 
@@ -87,6 +87,13 @@ public:
 	 * @param[out] val
 	 */
 	static bool toBytes(class Bytes* val, const std::string &str);
+	/**
+	 * @brief Decodes the Base64 content of `val` in place, without any
+	 *   intermediate buffer.
+	 *
+	 * @param[in, out] val
+	 */
+	static bool toBytes(class Bytes* val);
 	/**
 	 * @param[out] val
 	 */
@@ -128,6 +128,8 @@ public:
 	typedef std::function<bool(const char* &, const char* &, const Variant* &, bool &)> VariableGetter;
 	typedef std::function<void(const char*, int, int, const char*, const char*, VariableGetter)> RecordGetter;
 
+	typedef std::function<void(const char*, const char*)> StatisticsGetter;
+
 	typedef std::shared_ptr<void> Invokable;
 
 public:
@@ -198,6 +200,14 @@ public:
 
 	virtual int getRecords(RecordGetter get) const = 0;
 
+	/**
+	 * @brief Sets a line of runtime statistics to show in the debug window.
+	 *
+	 * @param[in] val `nullptr` to remove the line.
+	 */
+	virtual void setStatistics(const char* key, const char* val /* nullable */) = 0;
+	virtual int getStatistics(StatisticsGetter get) const = 0;
+
 	/**
 	 * @param[out] type
 	 * @param[out] var
@@ -11,6 +11,14 @@
 #include "bytes.h"
 #include "encoding.h"
 #include "file_handle.h"
+#if defined BITTY_OS_WIN
+#	include <Windows.h>
+#elif !defined BITTY_OS_HTML
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif /* Platform macro. */
 
 /*
 ** {===========================================================================
@@ -496,3 +504,170 @@ void File::destroy(File* ptr) {
 }
 
 /* ===========================================================================} */
+
+/*
+** {===========================================================================
+** Mapped file
+*/
+
+class MappedFileImpl : public MappedFile {
+private:
+#if defined BITTY_OS_WIN
+	HANDLE _file = INVALID_HANDLE_VALUE;
+	HANDLE _mapping = nullptr;
+#elif defined BITTY_OS_HTML
+	Byte* _buffer = nullptr;
+#endif /* Platform macro. */
+	const Byte* _pointer = nullptr;
+	size_t _count = 0;
+	bool _opened = false;
+
+public:
+	MappedFileImpl() {
+	}
+	virtual ~MappedFileImpl() override {
+		close();
+	}
+
+	virtual unsigned type(void) const override {
+		return TYPE();
+	}
+
+	virtual const Byte* pointer(void) const override {
+		return _pointer;
+	}
+	virtual size_t count(void) const override {
+		return _count;
+	}
+
+	virtual bool open(const char* path) override {
+		close();
+
+		if (!path)
+			return false;
+
+#if defined BITTY_OS_WIN
+		const std::wstring wstr = Unicode::toWide(path);
+		_file = CreateFileW(
+			wstr.c_str(),
+			GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr
+		);
+		if (_file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER len;
+		if (!GetFileSizeEx(_file, &len)) {
+			close();
+
+			return false;
+		}
+		_count = (size_t)len.QuadPart;
+		if (_count) { // Cannot map an empty file.
+			_mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!_mapping) {
+				close();
+
+				return false;
+			}
+			_pointer = (const Byte*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+			if (!_pointer) {
+				close();
+
+				return false;
+			}
+		}
+#elif defined BITTY_OS_HTML
+		const std::string osstr = Unicode::toOs(path);
+		FILE* fp = fopen(osstr.c_str(), "rb");
+		if (!fp)
+			return false;
+
+		fseek(fp, 0L, SEEK_END);
+		const long len = ftell(fp);
+		fseek(fp, 0L, SEEK_SET);
+		if (len > 0) { // The virtual filesystem lives in memory already, fall back to a plain copy.
+			_buffer = (Byte*)malloc((size_t)len);
+			if (!_buffer || fread(_buffer, 1, (size_t)len, fp) != (size_t)len) {
+				fclose(fp);
+				close();
+
+				return false;
+			}
+			_pointer = _buffer;
+			_count = (size_t)len;
+		}
+		fclose(fp);
+#else /* Platform macro. */
+		const std::string osstr = Unicode::toOs(path);
+		const int fd = ::open(osstr.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0) {
+			::close(fd);
+
+			return false;
+		}
+		_count = (size_t)st.st_size;
+		if (_count) { // Cannot map an empty file.
+			void* ptr = mmap(nullptr, _count, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (ptr == MAP_FAILED) {
+				::close(fd);
+				_count = 0;
+
+				return false;
+			}
+			_pointer = (const Byte*)ptr;
+		}
+		::close(fd); // The mapping holds its own reference to the file.
+#endif /* Platform macro. */
+
+		_opened = true;
+
+		return true;
+	}
+	virtual bool close(void) override {
+#if defined BITTY_OS_WIN
+		if (_pointer)
+			UnmapViewOfFile(_pointer);
+		if (_mapping) {
+			CloseHandle(_mapping);
+			_mapping = nullptr;
+		}
+		if (_file != INVALID_HANDLE_VALUE) {
+			CloseHandle(_file);
+			_file = INVALID_HANDLE_VALUE;
+		}
+#elif defined BITTY_OS_HTML
+		if (_buffer) {
+			free(_buffer);
+			_buffer = nullptr;
+		}
+#else /* Platform macro. */
+		if (_pointer)
+			munmap((void*)_pointer, _count);
+#endif /* Platform macro. */
+		_pointer = nullptr;
+		_count = 0;
+
+		const bool result = _opened;
+		_opened = false;
+
+		return result;
+	}
+};
+
+MappedFile* MappedFile::create(void) {
+	MappedFileImpl* result = new MappedFileImpl();
+
+	return result;
+}
+
+void MappedFile::destroy(MappedFile* ptr) {
+	MappedFileImpl* impl = static_cast<MappedFileImpl*>(ptr);
+	delete impl;
+}
+
+/* ===========================================================================} */
@@ -42,4 +42,39 @@ public:
 
 /* ===========================================================================} */
 
+/*
+** {===========================================================================
+** Mapped file
+*/
+
+/**
+ * @brief Read-only memory mapped file.
+ *
+ * @note The mapped range stays valid until `close` or destruction, it's safe
+ *   to read from multiple threads concurrently. The file must not be
+ *   truncated or rewritten meanwhile, reading through a mapping of a
+ *   truncated file raises a bus error on POSIX platforms.
+ */
+class MappedFile : public virtual Object {
+public:
+	typedef std::shared_ptr<MappedFile> Ptr;
+
+public:
+	BITTY_CLASS_TYPE('F', 'I', 'L', 'M')
+
+	/**
+	 * @return Pointer to the mapped range, `nullptr` if not opened or empty.
+	 */
+	virtual const Byte* pointer(void) const = 0;
+	virtual size_t count(void) const = 0;
+
+	virtual bool open(const char* path) = 0;
+	virtual bool close(void) = 0;
+
+	static MappedFile* create(void);
+	static void destroy(MappedFile* ptr);
+};
+
+/* ===========================================================================} */
+
 #endif /* __FILE_H__ */
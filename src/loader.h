@@ -43,7 +43,8 @@ public:
 
 	/**
 	 * @brief Decodes a `Bytes` buffer after loading an asset. The return value
-	 *   reuses the input object rather than creating new one.
+	 *   reuses the input object rather than creating new one. This may be called
+	 *   from worker threads when a project preloads.
 	 *
 	 * @param[in] project The project to work on.
 	 * @param[in] asset The asset to decode.
@@ -61,8 +61,8 @@ public:
 		NONE = 0,
 		UDP = 1 << 0,
 		TCP = 1 << 1,
-		WEBSOCKET = 1 << 2, // Reserved.
-		ALL = UDP | TCP
+		WEBSOCKET = 1 << 2,
+		ALL = UDP | TCP | WEBSOCKET
 	};
 
 	enum States {
@@ -77,6 +77,10 @@ public:
 		char text[64]; // Enough for even IPv6 address and port.
 	} AddressName;
 
+	/**
+	 * @brief Data of `STREAM` and `BYTES` messages are passed as views over the
+	 *   receiving buffer, which are valid only during the callback.
+	 */
 	struct ReceivedHandler : public Handler<ReceivedHandler, void, ReceivedHandler*, void*, size_t, const char*> {
 		using Handler::Handler;
 	};
@@ -14,7 +14,9 @@
 #include "encoding.h"
 #include "json.h"
 #include "network_libuv.h"
+#include "platform.h"
 #include "text.h"
+#include <random>
 #if defined BITTY_OS_HTML
 	/* Do nothing. */
 #elif defined BITTY_OS_WIN || defined BITTY_OS_MAC || defined BITTY_OS_LINUX
@@ -46,6 +48,24 @@
 #	define NETWORK_DEFAULT_BACKLOG 128
 #endif /* NETWORK_DEFAULT_BACKLOG */
 
+#ifndef NETWORK_READ_BUFFER_SIZE
+#	define NETWORK_READ_BUFFER_SIZE 65536
+#endif /* NETWORK_READ_BUFFER_SIZE */
+#ifndef NETWORK_READ_BUFFER_SLAB_COUNT
+#	define NETWORK_READ_BUFFER_SLAB_COUNT 4
+#endif /* NETWORK_READ_BUFFER_SLAB_COUNT */
+
+#ifndef NETWORK_WRITE_REQUEST_POOL_SIZE
+#	define NETWORK_WRITE_REQUEST_POOL_SIZE 16
+#endif /* NETWORK_WRITE_REQUEST_POOL_SIZE */
+
+#ifndef NETWORK_WEBSOCKET_GUID
+#	define NETWORK_WEBSOCKET_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+#endif /* NETWORK_WEBSOCKET_GUID */
+#ifndef NETWORK_WEBSOCKET_HANDSHAKE_MAX_SIZE
+#	define NETWORK_WEBSOCKET_HANDSHAKE_MAX_SIZE 8192
+#endif /* NETWORK_WEBSOCKET_HANDSHAKE_MAX_SIZE */
+
 #ifndef NETWORK_STATE
 #	define NETWORK_STATE(P, I, W, O) \
 	VariableGuard<decltype(P)> __PROC__(&(P), (I), (W)); \
@@ -163,112 +183,152 @@ static void networkAddressToString(const uv_tcp_t* tcp, Network::AddressName &ad
 	memcpy(addr.text, str.c_str(), std::min(sizeof(Network::AddressName), str.length()));
 }
 
-static void networkWrite(uv_stream_t* handle, const Byte* buf, size_t len) {
-	typedef struct {
-		uv_write_t req;
-		uv_buf_t buf;
-	} write_req_t;
-
-	write_req_t* req = (write_req_t*)malloc(sizeof(write_req_t));
-	req->buf = uv_buf_init((char*)buf, (unsigned int)len);
-	uv_write(
-		(uv_write_t*)req, handle, &req->buf, 1,
-		[] (uv_write_t* req, int status) -> void {
-			if (status)
-				fprintf(stderr, "Write error %s.\n", uv_strerror(status));
+static UInt32 networkRandom(void) {
+	static thread_local std::mt19937 engine((std::random_device())());
 
-			write_req_t* wr = (write_req_t*)req;
-			free(wr);
-		}
-	);
+	return (UInt32)engine();
 }
 
-static bool networkSend(
-	uv_stream_t* handle, bool limitedSize,
-	const Byte* buf, size_t len, bool bytesWithSize, bool withEos
-) {
-	size_t sz = len;
-	if (bytesWithSize)
-		sz += sizeof(Network::BytesSize);
-	if (withEos)
-		++sz;
-	if (limitedSize && sz > NETWORK_MESSAGE_MAX_SIZE)
-		return false;
+static void networkSha1(const Byte* data, size_t len, Byte digest[20]) {
+	auto rol = [] (UInt32 val, int bits) -> UInt32 {
+		return (val << bits) | (val >> (32 - bits));
+	};
 
-	if (bytesWithSize) {
-		Network::BytesSize head = (Network::BytesSize)(len + sizeof(Network::BytesSize));
-		networkWrite(handle, (const Byte*)&head, 4);
-	}
-	networkWrite(handle, buf, len);
-	if (withEos) {
-		constexpr const char eos[1] = { '\0' };
-		networkWrite(handle, (const Byte*)eos, 1);
+	UInt32 h[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+	std::string msg((const char*)data, len);
+	msg.push_back((char)0x80);
+	while (msg.length() % 64 != 56)
+		msg.push_back('\0');
+	const UInt64 bits = (UInt64)len * 8;
+	for (int i = 7; i >= 0; --i)
+		msg.push_back((char)(Byte)(bits >> (i * 8)));
+
+	for (size_t chunk = 0; chunk < msg.length(); chunk += 64) {
+		const Byte* p = (const Byte*)msg.c_str() + chunk;
+		UInt32 w[80];
+		for (int i = 0; i < 16; ++i)
+			w[i] = ((UInt32)p[i * 4] << 24) | ((UInt32)p[i * 4 + 1] << 16) | ((UInt32)p[i * 4 + 2] << 8) | (UInt32)p[i * 4 + 3];
+		for (int i = 16; i < 80; ++i)
+			w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+		UInt32 a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+		for (int i = 0; i < 80; ++i) {
+			UInt32 f = 0, k = 0;
+			if (i < 20) {
+				f = (b & c) | (~b & d);
+				k = 0x5a827999;
+			} else if (i < 40) {
+				f = b ^ c ^ d;
+				k = 0x6ed9eba1;
+			} else if (i < 60) {
+				f = (b & c) | (b & d) | (c & d);
+				k = 0x8f1bbcdc;
+			} else {
+				f = b ^ c ^ d;
+				k = 0xca62c1d6;
+			}
+			const UInt32 tmp = rol(a, 5) + f + e + k + w[i];
+			e = d;
+			d = c;
+			c = rol(b, 30);
+			b = a;
+			a = tmp;
+		}
+		h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
 	}
 
-	return true;
+	for (int i = 0; i < 20; ++i)
+		digest[i] = (Byte)(h[i / 4] >> (24 - (i % 4) * 8));
 }
 
-static bool networkBroadcast(
-	NetworkLibuv::TcpClientHandles &clients, bool limitedSize,
-	const Byte* buf, size_t len, bool bytesWithSize, bool withEos
-) {
-	bool ret = true;
-	for (uv_tcp_t* tcp : clients) {
-		if (!networkSend((uv_stream_t*)tcp, limitedSize, buf, len, bytesWithSize, withEos))
-			ret = false;
-	}
+static std::string networkBase64(const Byte* data, size_t len) {
+	Bytes* bytes = Bytes::create();
+	bytes->writeBytes(data, len);
+	std::string ret;
+	Base64::fromBytes(ret, bytes);
+	Bytes::destroy(bytes);
 
 	return ret;
-};
-
-static Bytes* networkReceiveBytes(uv_stream_t* /* handle */, ssize_t /* nread */, const uv_buf_t* /* buf */, bool bytesWithSize, Bytes* cached, Bytes* receiving) {
-	if (bytesWithSize) {
-		if (receiving->count() >= sizeof(Network::BytesSize)) {
-			Network::BytesSize* up = (Network::BytesSize*)receiving->pointer();
-			if (receiving->count() >= *up) {
-				if (cached) {
-					cached->clear();
-					cached->writeBytes(
-						(const Byte*)(receiving->pointer() + sizeof(Network::BytesSize)),
-						(size_t)(*up - sizeof(Network::BytesSize))
-					);
-				} else {
-					assert(false && "Wrong data.");
-				}
-				receiving->removeFront((size_t)(*up));
+}
 
-				return cached;
-			}
-		}
-	} else {
-		if (receiving->count() > 0) {
-			if (cached) {
-				cached->clear();
-				cached->writeBytes(receiving->pointer(), receiving->count());
-			} else {
-				assert(false && "Wrong data.");
-			}
-			receiving->removeFront(receiving->count());
+static std::string networkWebSocketAccept(const std::string &key) {
+	const std::string str = key + NETWORK_WEBSOCKET_GUID;
+	Byte digest[20];
+	networkSha1((const Byte*)str.c_str(), str.length(), digest);
 
-			return cached;
+	return networkBase64(digest, sizeof(digest));
+}
+
+static size_t networkParseHttpHead(const Byte* data, size_t len, std::string &line, Text::Dictionary &fields) {
+	size_t end = 0;
+	for (size_t i = 0; i + 3 < len; ++i) {
+		if (memcmp(data + i, "\r\n\r\n", 4) == 0) {
+			end = i;
+
+			break;
 		}
 	}
+	if (end == 0)
+		return 0;
 
-	return nullptr;
-}
+	const Text::Array lines = Text::split(std::string((const char*)data, end), "\r\n");
+	if (lines.empty())
+		return 0;
 
-static bool networkReceiveUntilEos(uv_stream_t* /* handle */, ssize_t /* nread */, const uv_buf_t* /* buf */, std::string &str, Bytes* receiving) {
-	for (size_t i = 0; i < receiving->count(); ++i) {
-		if (i >= NETWORK_MESSAGE_MAX_SIZE || receiving->get(i) == '\0') {
-			str.clear();
-			str.assign((const char*)receiving->pointer(), i);
-			receiving->removeFront(i + 1);
+	line = lines.front();
+	for (size_t i = 1; i < lines.size(); ++i) {
+		const size_t colon = lines[i].find(':');
+		if (colon == std::string::npos)
+			continue;
 
-			return true;
-		}
+		std::string key = Text::trim(lines[i].substr(0, colon));
+		Text::toLowerCase(key);
+		fields[key] = Text::trim(lines[i].substr(colon + 1));
 	}
 
-	return false;
+	return end + 4;
+}
+
+static void networkWebSocketFrame(NetworkLibuv::WriteRequest::Message &msg, Byte opcode, bool masked) {
+	const UInt64 len = (UInt64)msg.payload->length();
+	unsigned n = 0;
+	msg.frame[n++] = (Byte)(0x80 | opcode); // FIN.
+	if (len < 126) {
+		msg.frame[n++] = (Byte)len;
+	} else if (len <= 0xffff) {
+		msg.frame[n++] = 126;
+		msg.frame[n++] = (Byte)(len >> 8);
+		msg.frame[n++] = (Byte)len;
+	} else {
+		msg.frame[n++] = 127;
+		for (int i = 7; i >= 0; --i)
+			msg.frame[n++] = (Byte)(len >> (i * 8));
+	}
+	if (masked) { // Client to server.
+		msg.frame[1] |= 0x80;
+		const UInt32 key = networkRandom();
+		memcpy(msg.frame + n, &key, 4);
+		std::string &payload = *msg.payload;
+		for (size_t i = 0; i < payload.length(); ++i)
+			payload[i] = (char)(payload[i] ^ msg.frame[n + (i & 3)]);
+		n += 4;
+	}
+	msg.frameSize = n;
+}
+
+static int networkReadStart(uv_stream_t* handle) {
+	return uv_read_start(
+		handle,
+		[] (uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf) -> void {
+			NetworkLibuv* self = (NetworkLibuv*)handle->data;
+			self->onAllocating(handle, suggested_size, buf);
+		},
+		[] (uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf) -> void {
+			NetworkLibuv* self = (NetworkLibuv*)handle->data;
+			self->onRead(handle, nread, buf);
+		}
+	);
 }
 
 #endif /* BITTY_NETWORK_ENABLED */
@@ -282,9 +342,19 @@ static bool networkReceiveUntilEos(uv_stream_t* /* handle */, ssize_t /* nread *
 
 #if BITTY_NETWORK_ENABLED
 
+void NetworkLibuv::WriteRequest::clear(void) {
+	owner = nullptr;
+	handle = nullptr;
+	messages.clear();
+	buffers.clear();
+}
+
 NetworkLibuv::NetworkLibuv() {
 	_loop = (uv_loop_t*)malloc(sizeof(uv_loop_t));
 	memset(_loop, 0, sizeof(uv_loop_t));
+#if BITTY_MULTITHREAD_ENABLED
+	memset(&_wakeup, 0, sizeof(uv_async_t));
+#endif /* BITTY_MULTITHREAD_ENABLED */
 
 #if defined BITTY_DEBUG
 	fprintf(stdout, "Network (libuv) created.\n");
@@ -312,6 +382,18 @@ NetworkLibuv::~NetworkLibuv() {
 		_tcp = nullptr;
 	}
 
+	for (WriteRequest* req : _writeQueue)
+		delete req;
+	_writeQueue.clear();
+	for (WriteRequest* req : _writePool)
+		delete req;
+	_writePool.clear();
+
+	for (char* slab : _readSlabs)
+		free(slab);
+	_readSlabs.clear();
+	_readPool.clear();
+
 	free(_loop);
 	_loop = nullptr;
 
@@ -392,6 +474,12 @@ bool NetworkLibuv::open(const char* addr, Protocols protocol, bool* toconn_, boo
 	}
 	assert((withudp || withtcp || withws) && "Unknown protocol.");
 
+	if (websocket()) {
+		const size_t slash = strdirt.find('/');
+		_webSocketPath = slash == std::string::npos ? "/" : strdirt.substr(slash);
+		strdirt = strdirt.substr(0, slash);
+	}
+
 	bool toconn = false, tobind = false;
 	std::string ipaddr;
 	int port = 0;
@@ -441,9 +529,15 @@ bool NetworkLibuv::open(const char* addr, Protocols protocol, bool* toconn_, boo
 	}
 	assert((toconn || tobind) && "Unknown operation.");
 
+	if (websocket())
+		_webSocketHost = ipaddr + ":" + Text::toString((Int32)port);
+
 	// Open.
 	doOpen(withudp, withtcp, withws, toconn, tobind, ipaddr.c_str(), port);
 
+	// Run the loop on the I/O thread if it's required.
+	start();
+
 	// Finish.
 	return true;
 }
@@ -451,7 +545,7 @@ bool NetworkLibuv::open(const char* addr, Protocols protocol, bool* toconn_, boo
 bool NetworkLibuv::close(void) {
 	// Closing during callback?
 	if (polling()) {
-		++_shutting;
+		_shutting = _shutting + 1;
 
 		return true;
 	}
@@ -461,6 +555,15 @@ bool NetworkLibuv::close(void) {
 		return false;
 	_opened = false;
 
+	stop();
+
+#if BITTY_MULTITHREAD_ENABLED
+	Event evt;
+	while (_inbound.pop(evt)) {
+		// Discard.
+	}
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
 	_ready = IDLE;
 	_shutting = 0;
 	_binded = false; _wasBinded = false;
@@ -471,16 +574,14 @@ bool NetworkLibuv::close(void) {
 	_stblHandler = EstablishedHandler();
 	_dscnHandler = DisconnectedHandler();
 
-	if (_bytesCache) {
-		Bytes::destroy(_bytesCache);
-		_bytesCache = nullptr;
-	}
 	if (_jsonCache) {
 		Json::destroy(_jsonCache);
 		_jsonCache = nullptr;
 	}
 
 	// Dispose.
+	flush(); // Issue the sends batched since the last poll.
+	discard(nullptr);
 	uv_walk(
 		_loop,
 		[] (uv_handle_t* handle, void* /* arg */) -> void {
@@ -490,16 +591,23 @@ bool NetworkLibuv::close(void) {
 	);
 	uv_run(_loop, UV_RUN_DEFAULT);
 	uv_loop_close(_loop);
+#if BITTY_MULTITHREAD_ENABLED
+	memset(&_wakeup, 0, sizeof(uv_async_t));
+#endif /* BITTY_MULTITHREAD_ENABLED */
 
-	if (_recvCache) {
-		Bytes::destroy(_recvCache);
-		_recvCache = nullptr;
-	}
+	for (ReceivingCaches::value_type &kv : _recvCaches)
+		Bytes::destroy(kv.second);
+	_recvCaches.clear();
+
+	_webSockets.clear();
+	_webSocketHost.clear();
+	_webSocketPath.clear();
 
 	// Clear options.
 	_options.clear();
 	_dataType = JSON;
 	_bytesWithSize = true;
+	_threaded = false;
 
 	// Call polymorphic.
 	doClose();
@@ -550,6 +658,12 @@ void NetworkLibuv::option(const std::string &key, const std::string &val) {
 				_dataType = JSON;
 				_bytesWithSize = true;
 			}
+		} else if (skey == "threaded") { // Boolean.
+#if BITTY_MULTITHREAD_ENABLED
+			std::string sval = val;
+			Text::toLowerCase(sval);
+			_threaded = sval == "true";
+#endif /* BITTY_MULTITHREAD_ENABLED */
 		}
 	}
 }
@@ -570,13 +684,19 @@ void NetworkLibuv::poll(int timeoutMs) {
 	if (!_opened && !_shutting)
 		return;
 
-	doPoll(timeoutMs);
+	if (_threaded)
+		drain();
+	else
+		doPoll(timeoutMs);
 }
 
 void NetworkLibuv::establish(void) {
 	const long long now = DateTime::ticks();
 	while (_ready == IDLE) {
-		doPoll(1);
+		if (_threaded)
+			DateTime::sleep(1);
+		else
+			doPoll(1);
 
 		const double diff = DateTime::toSeconds(DateTime::ticks() - now);
 		if (diff > (1.0 * (NETWORK_TIMEOUT_SECONDS)))
@@ -588,6 +708,16 @@ void NetworkLibuv::disconnect(void) {
 	if (!_opened)
 		return;
 
+	stop();
+
+	if (websocket()) {
+		for (WebSockets::value_type &kv : _webSockets) {
+			if (kv.second.handshaken)
+				frame(kv.first, WebSocket::CLOSE, std::string("\x03\xe8", 2)); // Normal closure.
+		}
+	}
+	flush();
+
 	auto disconnect_ = [this] (uv_tcp_t* tcp) -> void {
 		//uv_stream_t* stream = _connect->handle;
 		uv_stream_t* stream = (uv_stream_t*)tcp;
@@ -640,16 +770,33 @@ void NetworkLibuv::disconnect(void) {
 
 		fprintf(stdout, "Network (0x%p) incoming shutdown.\n", (Network*)this);
 	}
+
+	// Resume the I/O thread to finish the pending shutdowns and to serve the
+	// rest handles.
+	start();
 }
 
 bool NetworkLibuv::send(void* ptr, size_t sz, DataTypes y) {
+#if BITTY_MULTITHREAD_ENABLED
+	if (_threaded) {
+		PushHandler pusher = std::bind(
+			&NetworkLibuv::post, this, Command::SEND,
+			std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4
+		);
+
+		return doPush(ptr, sz, y, pusher);
+	}
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
 	if (!_connect)
 		return false;
 
-	PushHandler pusher = std::bind(
-		networkSend, _connect->handle, false,
-		std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4
-	);
+	uv_stream_t* handle = _connect->handle;
+	PushHandler pusher = [this, handle] (const Byte* buf, size_t len, bool bytesWithSize, bool withEos) -> bool {
+		WriteRequest::Payload payload(new std::string((const char*)buf, len));
+
+		return enqueue(handle, false, payload, bytesWithSize, withEos);
+	};
 
 	return doPush(ptr, sz, y, pusher);
 }
@@ -660,22 +807,46 @@ bool NetworkLibuv::broadcast(void* ptr, size_t sz, DataTypes y) {
 	if (!connective())
 		return false;
 
+#if BITTY_MULTITHREAD_ENABLED
+	if (_threaded) {
+		PushHandler pusher = std::bind(
+			&NetworkLibuv::post, this, Command::BROADCAST,
+			std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4
+		);
+
+		return doPush(ptr, sz, y, pusher);
+	}
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
 	if (_tcpClients.empty())
 		return true;
 
-	PushHandler pusher = std::bind(
-		networkBroadcast, _tcpClients, false,
-		std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4
-	);
+	PushHandler pusher = [this] (const Byte* buf, size_t len, bool bytesWithSize, bool withEos) -> bool {
+		WriteRequest::Payload payload(new std::string((const char*)buf, len)); // Shared by all clients.
+		bool ret = true;
+		for (uv_tcp_t* tcp : _tcpClients) {
+			if (!enqueue((uv_stream_t*)tcp, false, payload, bytesWithSize, withEos))
+				ret = false;
+		}
+
+		return ret;
+	};
 
 	return doPush(ptr, sz, y, pusher);
 }
 
 bool NetworkLibuv::update(double /* delta */) {
-	if (!ready())
-		return true;
+	if (_threaded) {
+		if (!_opened)
+			return true;
 
-	doPoll(_timeoutMs);
+		drain();
+	} else {
+		if (!ready())
+			return true;
+
+		doPoll(_timeoutMs);
+	}
 
 	if (_shutting)
 		close();
@@ -731,37 +902,19 @@ void NetworkLibuv::onAccepted(uv_stream_t* handle, int status) {
 		networkAddressToString(client, addr);
 		fprintf(stdout, "Network (0x%p) incoming established: %s.\n", (Network*)this, addr.text);
 
-		uv_read_start(
-			(uv_stream_t*)client,
-			[] (uv_handle_t* /* handle */, size_t suggested_size, uv_buf_t* buf) -> void {
-				buf->base = (char*)malloc(suggested_size);
-				buf->len = (decltype(buf->len))suggested_size;
-			},
-			[] (uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf) -> void {
-				NetworkLibuv* self = (NetworkLibuv*)handle->data;
-				if (nread > 0) {
-					self->onReceived(handle, nread, buf);
-					free(buf->base);
-				} else if (nread == UV_EOF) {
-					self->onClosed(handle);
-					if (buf->base)
-						free(buf->base);
-				}
-			}
-		);
+		networkReadStart((uv_stream_t*)client);
 	} else {
 		uv_close((uv_handle_t*)client, nullptr);
 	}
 
-	if (!establishedCallback().empty()) {
-		EstablishedHandler &handler = const_cast<EstablishedHandler &>(establishedCallback());
-		handler(&handler, addr.text);
-	}
+	if (!websocket()) // Established after handshaking for WebSocket.
+		established(addr.text);
 }
 
 void NetworkLibuv::onConnected(uv_connect_t* svr, int status) {
 	if (status == 0) {
-		_ready = READY;
+		if (!websocket()) // Ready after handshaking for WebSocket.
+			_ready = READY;
 
 		AddressName addr;
 		networkAddressToString((const uv_tcp_t*)svr->handle, addr);
@@ -769,29 +922,34 @@ void NetworkLibuv::onConnected(uv_connect_t* svr, int status) {
 		if (!connective())
 			return;
 
-		uv_read_start(
-			svr->handle,
-			[] (uv_handle_t* /* handle */, size_t suggested_size, uv_buf_t* buf) -> void {
-				buf->base = (char*)malloc(suggested_size);
-				buf->len = (decltype(buf->len))suggested_size;
-			},
-			[] (uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf) -> void {
-				NetworkLibuv* self = (NetworkLibuv*)handle->data;
-				if (nread > 0) {
-					self->onReceived(handle, nread, buf);
-					free(buf->base);
-				} else if (nread == UV_EOF) {
-					self->onClosed(handle);
-					if (buf->base)
-						free(buf->base);
-				}
+		networkReadStart(svr->handle);
+
+		if (websocket()) {
+			Byte nonce[16];
+			for (int i = 0; i < (int)sizeof(nonce); i += 4) {
+				const UInt32 val = networkRandom();
+				memcpy(nonce + i, &val, 4);
 			}
-		);
+			const std::string key = networkBase64(nonce, sizeof(nonce));
+			_webSockets[svr->handle].accept = networkWebSocketAccept(key);
+
+			WriteRequest::Message msg;
+			msg.payload = WriteRequest::Payload(new std::string(
+				"GET " + _webSocketPath + " HTTP/1.1\r\n"
+				"Host: " + _webSocketHost + "\r\n"
+				"Upgrade: websocket\r\n"
+				"Connection: Upgrade\r\n"
+				"Sec-WebSocket-Key: " + key + "\r\n"
+				"Sec-WebSocket-Version: 13\r\n"
+				"\r\n"
+			));
+			push(svr->handle, msg);
+			flush();
 
-		if (!establishedCallback().empty()) {
-			EstablishedHandler &handler = const_cast<EstablishedHandler &>(establishedCallback());
-			handler(&handler, addr.text);
+			return;
 		}
+
+		established(addr.text);
 	} else {
 		if (_ready == FAILED)
 			return;
@@ -810,103 +968,75 @@ void NetworkLibuv::onConnected(uv_connect_t* svr, int status) {
 			return;
 #endif /* NETWORK_NONCONNECTIVE_CLOSING_ENABLED */
 
-		if (!establishedCallback().empty()) {
-			EstablishedHandler &handler = const_cast<EstablishedHandler &>(establishedCallback());
-			handler(&handler, nullptr);
-		}
+		established(nullptr);
 	}
 }
 
+void NetworkLibuv::onAllocating(uv_handle_t* /* handle */, size_t /* suggestedSize */, uv_buf_t* buf) {
+	buf->base = acquireReadBuffer();
+	buf->len = (decltype(buf->len))NETWORK_READ_BUFFER_SIZE;
+}
+
+void NetworkLibuv::onRead(uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf) {
+	if (nread > 0)
+		onReceived(handle, nread, buf);
+	else if (nread == UV_EOF)
+		onClosed(handle);
+
+	if (buf->base)
+		releaseReadBuffer(buf->base);
+}
+
 void NetworkLibuv::onReceived(uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf) {
-	if (!ready())
+	if (!ready() && !(websocket() && _opened && _ready == IDLE)) // Handshaking WebSocket.
+		return;
+	if (!_threaded && receivedCallback().empty())
 		return;
 
 	AddressName addr;
 	networkAddressToString((const uv_tcp_t*)handle, addr);
-	switch (_dataType) {
-	case STREAM: {
-			if (!receivedCallback().empty()) {
-				Bytes* receiving = recvCache();
-				receiving->clear();
-				receiving->writeBytes((const Byte*)buf->base, (size_t)nread);
-
-				Bytes* cached = (!receivedCallback().empty()) ? bytesCache() : nullptr;
-				Bytes* bytes = networkReceiveBytes(handle, nread, buf, false, cached, receiving);
-				while (bytes) {
-					if (!receivedCallback().empty()) {
-						ReceivedHandler &handler = const_cast<ReceivedHandler &>(receivedCallback());
-						handler(&handler, cached, cached->count(), addr.text);
-					}
-
-					bytes = networkReceiveBytes(handle, nread, buf, false, cached, receiving);
-				}
-			}
-		}
 
-		break;
-	case BYTES: {
-			if (!receivedCallback().empty()) {
-				Bytes* receiving = recvCache();
-				receiving->clear();
-				receiving->writeBytes((const Byte*)buf->base, (size_t)nread);
-
-				Bytes* cached = (!receivedCallback().empty()) ? bytesCache() : nullptr;
-				Bytes* bytes = networkReceiveBytes(handle, nread, buf, _bytesWithSize, cached, receiving);
-				while (bytes) {
-					if (!receivedCallback().empty()) {
-						ReceivedHandler &handler = const_cast<ReceivedHandler &>(receivedCallback());
-						handler(&handler, cached, cached->count(), addr.text);
-					}
+	// Complete messages are dispatched as views over the read buffer, only an
+	// incomplete tail is copied to be continued by the following reads.
+	Bytes* receiving = takeRecvCache(handle);
+	const bool pending = receiving && receiving->count() > 0;
+	const Byte* data = (const Byte*)buf->base;
+	size_t len = (size_t)nread;
+	if (pending) {
+		receiving->writeBytes(data, len);
+		data = receiving->pointer();
+		len = receiving->count();
+	}
 
-					bytes = networkReceiveBytes(handle, nread, buf, _bytesWithSize, cached, receiving);
-				}
-			}
-		}
+	const size_t consumed = dispatch(handle, data, len, addr.text);
 
-		break;
-	case STRING: {
-			if (!receivedCallback().empty()) {
-				Bytes* receiving = recvCache();
-				receiving->clear();
-				receiving->writeBytes((const Byte*)buf->base, (size_t)nread);
-
-				while (networkReceiveUntilEos(handle, nread, buf, _stringCache, receiving)) {
-					if (!receivedCallback().empty()) {
-						ReceivedHandler &handler = const_cast<ReceivedHandler &>(receivedCallback());
-						handler(&handler, (void*)_stringCache.c_str(), _stringCache.length(), addr.text);
-					}
-				}
-			}
-		}
+	if (!alive(handle)) {
+		if (receiving)
+			Bytes::destroy(receiving);
 
-		break;
-	case JSON: {
-			if (!receivedCallback().empty()) {
-				Bytes* receiving = recvCache();
-				receiving->clear();
-				receiving->writeBytes((const Byte*)buf->base, (size_t)nread);
-
-				while (networkReceiveUntilEos(handle, nread, buf, _stringCache, receiving)) {
-					if (!receivedCallback().empty()) {
-						Json* cached = jsonCache();
-						cached->fromString(_stringCache);
-
-						ReceivedHandler &handler = const_cast<ReceivedHandler &>(receivedCallback());
-						handler(&handler, (void*)cached, 0, addr.text);
-					}
-				}
-			}
-		}
-
-		break;
-	default:
-		assert(false && "Unknown data type.");
-
-		break;
+		return;
+	}
+	if (pending) {
+		receiving->removeFront(consumed);
+	} else if (consumed < len) {
+		if (!receiving)
+			receiving = Bytes::create();
+		receiving->clear();
+		receiving->writeBytes(data + consumed, len - consumed);
 	}
+	if (receiving)
+		keepRecvCache(handle, receiving);
 }
 
 void NetworkLibuv::onClosed(uv_stream_t* handle) {
+	discard(handle);
+
+	_webSockets.erase(handle);
+
+	Bytes* receiving = takeRecvCache(handle);
+	if (receiving)
+		Bytes::destroy(receiving);
+
 	if (_wasBinded) {
 		AddressName addr;
 		networkAddressToString((const uv_tcp_t*)handle, addr);
@@ -916,10 +1046,7 @@ void NetworkLibuv::onClosed(uv_stream_t* handle) {
 		if (!connective())
 			return;
 
-		if (!disconnectedCallback().empty()) {
-			DisconnectedHandler &handler = const_cast<DisconnectedHandler &>(disconnectedCallback());
-			handler(&handler, addr.text);
-		}
+		disconnected(addr.text);
 
 		TcpClientHandles::iterator it = std::find_if(
 			_tcpClients.begin(), _tcpClients.end(),
@@ -950,16 +1077,46 @@ void NetworkLibuv::onClosed(uv_stream_t* handle) {
 			return;
 #endif /* NETWORK_NONCONNECTIVE_CLOSING_ENABLED */
 
-		if (!disconnectedCallback().empty()) {
-			DisconnectedHandler &handler = const_cast<DisconnectedHandler &>(disconnectedCallback());
-			handler(&handler, addr.text);
+		disconnected(addr.text);
+	}
+}
+
+void NetworkLibuv::onWritten(WriteRequest* req, int status) {
+	if (status)
+		fprintf(stderr, "Write error %s.\n", uv_strerror(status));
+
+	releaseWriteRequest(req);
+}
+
+#if BITTY_MULTITHREAD_ENABLED
+void NetworkLibuv::onWakeup(void) {
+	Command cmd;
+	while (_outbound.pop(cmd)) {
+		switch (cmd.type) {
+		case Command::SEND:
+			if (_connect)
+				enqueue(_connect->handle, false, cmd.payload, cmd.bytesWithSize, cmd.withEos);
+
+			break;
+		case Command::BROADCAST:
+			for (uv_tcp_t* tcp : _tcpClients)
+				enqueue((uv_stream_t*)tcp, false, cmd.payload, cmd.bytesWithSize, cmd.withEos);
+
+			break;
+		case Command::STOP:
+			uv_stop(_loop);
+
+			break;
 		}
 	}
+
+	flush();
 }
+#endif /* BITTY_MULTITHREAD_ENABLED */
 
 void NetworkLibuv::doOpen(bool withudp, bool withtcp, bool withws, bool toconn, bool tobind, const char* ipaddr, int port) {
 	_wasBinded = _binded = tobind;
-	if (withudp || withtcp) {
+	if (withudp || withtcp || withws) {
 		if (toconn) {
 			memset(&_address, 0, sizeof(sockaddr_in));
 			uv_ip4_addr(ipaddr, port, &_address);
@@ -973,7 +1130,7 @@ void NetworkLibuv::doOpen(bool withudp, bool withtcp, bool withws, bool toconn,
 				uv_udp_init(_loop, _udp);
 
 				ret = uv_udp_connect(_udp, (const struct sockaddr*)&_address);
-			} else if (withtcp) {
+			} else if (withtcp || withws) {
 				if (!_tcp)
 					_tcp = (uv_tcp_t*)malloc(sizeof(uv_tcp_t));
 				memset(_tcp, 0, sizeof(uv_tcp_t));
@@ -1013,7 +1170,7 @@ void NetworkLibuv::doOpen(bool withudp, bool withtcp, bool withws, bool toconn,
 				uv_udp_init(_loop, _udp);
 
 				uv_udp_bind(_udp, (const struct sockaddr*)&_address, 0);
-			} else if (withtcp) {
+			} else if (withtcp || withws) {
 				if (!_tcp)
 					_tcp = (uv_tcp_t*)malloc(sizeof(uv_tcp_t));
 				memset(_tcp, 0, sizeof(uv_tcp_t));
@@ -1038,8 +1195,6 @@ void NetworkLibuv::doOpen(bool withudp, bool withtcp, bool withws, bool toconn,
 
 			_ready = ret ? IDLE : READY;
 		}
-	} else if (withws) {
-		assert(false && "Not implemented.");
 	}
 }
 
@@ -1050,6 +1205,8 @@ void NetworkLibuv::doClose(void) {
 void NetworkLibuv::doPoll(int /* timeoutMs */) {
 	NETWORK_STATE(_polling, false, true, return)
 
+	flush();
+
 	for (int i = 0; i < 2000; ++i) {
 		if (!uv_run(_loop, UV_RUN_NOWAIT))
 			break;
@@ -1123,18 +1280,686 @@ bool NetworkLibuv::doPush(void* ptr, size_t sz, DataTypes y, PushHandler pusher)
 	return true;
 }
 
-class Bytes* NetworkLibuv::recvCache(void) {
-	if (!_recvCache)
-		_recvCache = Bytes::create();
+bool NetworkLibuv::enqueue(uv_stream_t* handle, bool limitedSize, const WriteRequest::Payload &payload, bool bytesWithSize, bool withEos) {
+	const size_t len = payload->length();
+	size_t sz = len;
+	if (bytesWithSize)
+		sz += sizeof(BytesSize);
+	if (withEos)
+		++sz;
+	if (limitedSize && sz > NETWORK_MESSAGE_MAX_SIZE)
+		return false;
+
+	WriteRequest::Message msg;
+	msg.payload = payload;
+	if (websocket()) { // Framed, strings and JSON as text, others as binary.
+		WebSockets::iterator it = _webSockets.find(handle);
+		if (it == _webSockets.end() || !it->second.handshaken)
+			return false;
+
+		networkWebSocketFrame(msg, withEos ? WebSocket::TEXT : WebSocket::BINARY, !_wasBinded);
+	} else {
+		msg.head = (BytesSize)(len + sizeof(BytesSize));
+		msg.withHead = bytesWithSize;
+		msg.withEos = withEos;
+	}
+	push(handle, msg);
+
+	return true;
+}
+
+void NetworkLibuv::push(uv_stream_t* handle, WriteRequest::Message &msg) {
+	// Find or create the pending request of the stream, messages to the same
+	// stream are batched till the next flush.
+	WriteRequest* req = nullptr;
+	for (WriteRequest* req_ : _writeQueue) {
+		if (req_->handle == handle) {
+			req = req_;
+
+			break;
+		}
+	}
+	if (!req) {
+		req = acquireWriteRequest();
+		req->handle = handle;
+		_writeQueue.push_back(req);
+	}
+
+	req->messages.push_back(msg);
+}
+
+void NetworkLibuv::flush(void) {
+	constexpr static const char EOS[1] = { '\0' };
+
+	if (_writeQueue.empty())
+		return;
+
+	WriteRequests queue;
+	std::swap(queue, _writeQueue);
+	for (WriteRequest* req : queue) {
+		// Build the buffers after all messages are enqueued, so that the
+		// addresses of the size heads are stable.
+		for (WriteRequest::Message &msg : req->messages) {
+			if (msg.frameSize)
+				req->buffers.push_back(uv_buf_init((char*)msg.frame, msg.frameSize));
+			if (msg.withHead)
+				req->buffers.push_back(uv_buf_init((char*)&msg.head, (unsigned int)sizeof(BytesSize)));
+			if (!msg.payload->empty())
+				req->buffers.push_back(uv_buf_init((char*)msg.payload->c_str(), (unsigned int)msg.payload->length()));
+			if (msg.withEos)
+				req->buffers.push_back(uv_buf_init((char*)EOS, 1));
+		}
+		if (req->buffers.empty()) {
+			releaseWriteRequest(req);
+
+			continue;
+		}
+
+		const int ret = uv_write(
+			&req->req, req->handle, &req->buffers.front(), (unsigned int)req->buffers.size(),
+			[] (uv_write_t* req, int status) -> void {
+				WriteRequest* wr = (WriteRequest*)req->data;
+				wr->owner->onWritten(wr, status);
+			}
+		);
+		if (ret) {
+			fprintf(stderr, "Write error %s.\n", uv_strerror(ret));
+
+			releaseWriteRequest(req);
+		}
+	}
+}
+
+void NetworkLibuv::discard(uv_stream_t* handle) {
+	WriteRequests::iterator it = _writeQueue.begin();
+	while (it != _writeQueue.end()) {
+		WriteRequest* req = *it;
+		if (!handle || req->handle == handle) {
+			releaseWriteRequest(req);
+			it = _writeQueue.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+NetworkLibuv::WriteRequest* NetworkLibuv::acquireWriteRequest(void) {
+	WriteRequest* req = nullptr;
+	if (_writePool.empty()) {
+		req = new WriteRequest();
+	} else {
+		req = _writePool.back();
+		_writePool.pop_back();
+	}
+	memset(&req->req, 0, sizeof(uv_write_t));
+	req->req.data = req;
+	req->owner = this;
 
-	return _recvCache;
+	return req;
 }
 
-class Bytes* NetworkLibuv::bytesCache(void) {
-	if (!_bytesCache)
-		_bytesCache = Bytes::create();
+void NetworkLibuv::releaseWriteRequest(WriteRequest* req) {
+	req->clear();
+	if (_writePool.size() < NETWORK_WRITE_REQUEST_POOL_SIZE)
+		_writePool.push_back(req);
+	else
+		delete req;
+}
+
+void NetworkLibuv::start(void) {
+#if BITTY_MULTITHREAD_ENABLED
+	if (!_threaded || _thread.joinable())
+		return;
+
+	if (!_wakeup.loop) { // Kept alive in the loop when resumed after a disconnection.
+		_wakeup.data = this;
+		uv_async_init(
+			_loop, &_wakeup,
+			[] (uv_async_t* handle) -> void {
+				NetworkLibuv* self = (NetworkLibuv*)handle->data;
+				self->onWakeup();
+			}
+		);
+	}
+
+	auto proc = [] (NetworkLibuv* self) -> void {
+		Platform::threadName("NETWORK");
+
+		uv_run(self->_loop, UV_RUN_DEFAULT); // Till stopped by the `STOP` command.
+	};
+	_thread = std::thread(proc, this);
+#endif /* BITTY_MULTITHREAD_ENABLED */
+}
+
+void NetworkLibuv::stop(void) {
+#if BITTY_MULTITHREAD_ENABLED
+	if (!_thread.joinable())
+		return;
+
+	Command cmd;
+	cmd.type = Command::STOP;
+	_outbound.push(std::move(cmd));
+	uv_async_send(&_wakeup);
+
+	_thread.join();
+#endif /* BITTY_MULTITHREAD_ENABLED */
+}
+
+void NetworkLibuv::drain(void) {
+#if BITTY_MULTITHREAD_ENABLED
+	NETWORK_STATE(_polling, false, true, return)
+
+	Event evt;
+	while (_opened && !_shutting && _inbound.pop(evt)) {
+		switch (evt.type) {
+		case Event::RECEIVED:
+			deliver(evt.data.c_str(), evt.data.length(), evt.address.c_str());
+
+			break;
+		case Event::ESTABLISHED:
+			if (!establishedCallback().empty()) {
+				EstablishedHandler &handler = const_cast<EstablishedHandler &>(establishedCallback());
+				handler(&handler, evt.failed ? nullptr : evt.address.c_str());
+			}
+
+			break;
+		case Event::DISCONNECTED:
+			if (!disconnectedCallback().empty()) {
+				DisconnectedHandler &handler = const_cast<DisconnectedHandler &>(disconnectedCallback());
+				handler(&handler, evt.address.c_str());
+			}
+
+			break;
+		}
+	}
+#endif /* BITTY_MULTITHREAD_ENABLED */
+}
+
+#if BITTY_MULTITHREAD_ENABLED
+bool NetworkLibuv::post(Command::Types y, const Byte* buf, size_t len, bool bytesWithSize, bool withEos) {
+	if (!_thread.joinable())
+		return false;
+
+	Command cmd;
+	cmd.type = y;
+	cmd.payload = WriteRequest::Payload(new std::string((const char*)buf, len));
+	cmd.bytesWithSize = bytesWithSize;
+	cmd.withEos = withEos;
+	_outbound.push(std::move(cmd));
+	uv_async_send(&_wakeup);
+
+	return true;
+}
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+void NetworkLibuv::established(const char* addr) {
+#if BITTY_MULTITHREAD_ENABLED
+	if (_threaded) {
+		Event evt;
+		evt.type = Event::ESTABLISHED;
+		if (addr)
+			evt.address = addr;
+		else
+			evt.failed = true;
+		_inbound.push(std::move(evt));
+
+		return;
+	}
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+	if (!establishedCallback().empty()) {
+		EstablishedHandler &handler = const_cast<EstablishedHandler &>(establishedCallback());
+		handler(&handler, addr);
+	}
+}
+
+void NetworkLibuv::disconnected(const char* addr) {
+#if BITTY_MULTITHREAD_ENABLED
+	if (_threaded) {
+		Event evt;
+		evt.type = Event::DISCONNECTED;
+		evt.address = addr;
+		_inbound.push(std::move(evt));
+
+		return;
+	}
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+	if (!disconnectedCallback().empty()) {
+		DisconnectedHandler &handler = const_cast<DisconnectedHandler &>(disconnectedCallback());
+		handler(&handler, addr);
+	}
+}
+
+void NetworkLibuv::received(const char* data, size_t len, const char* addr) {
+#if BITTY_MULTITHREAD_ENABLED
+	if (_threaded) {
+		Event evt;
+		evt.type = Event::RECEIVED;
+		evt.data.assign(data, len);
+		evt.address = addr;
+		_inbound.push(std::move(evt));
+
+		return;
+	}
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+	deliver(data, len, addr);
+}
+
+void NetworkLibuv::deliver(const char* data, size_t len, const char* addr) {
+	if (receivedCallback().empty())
+		return;
+
+	ReceivedHandler &handler = const_cast<ReceivedHandler &>(receivedCallback());
+	switch (_dataType) {
+	case STREAM: // Fall through.
+	case BYTES: // Fall through.
+	case STRING:
+		handler(&handler, (void*)data, len, addr);
+
+		break;
+	case JSON: {
+			_stringCache.assign(data, len);
+			Json* cached = jsonCache();
+			cached->fromString(_stringCache);
+
+			handler(&handler, (void*)cached, 0, addr);
+		}
+
+		break;
+	default:
+		assert(false && "Unknown data type.");
+
+		break;
+	}
+}
+
+bool NetworkLibuv::alive(uv_stream_t* handle) const {
+	if (_connect && _connect->handle == handle)
+		return true;
+
+	return std::find(_tcpClients.begin(), _tcpClients.end(), (uv_tcp_t*)handle) != _tcpClients.end();
+}
+
+size_t NetworkLibuv::dispatch(uv_stream_t* handle, const Byte* data, size_t len, const char* addr) {
+	if (websocket()) // Owned by either the read buffer or the receiving cache.
+		return dispatchWebSocket(handle, const_cast<Byte*>(data), len, addr);
+
+	size_t consumed = 0;
+	switch (_dataType) {
+	case STREAM:
+		received((const char*)data, len, addr);
+		consumed = len;
+
+		break;
+	case BYTES:
+		if (!_bytesWithSize) {
+			received((const char*)data, len, addr);
+			consumed = len;
+
+			break;
+		}
+
+		while (len - consumed >= sizeof(BytesSize)) {
+			BytesSize head = 0;
+			memcpy(&head, data + consumed, sizeof(BytesSize));
+			if (head < sizeof(BytesSize)) {
+				fprintf(stderr, "Network (0x%p) received malformed data.\n", (Network*)this);
+
+				consumed = len;
+
+				break;
+			}
+			if (len - consumed < head)
+				break;
+
+			received((const char*)(data + consumed + sizeof(BytesSize)), (size_t)(head - sizeof(BytesSize)), addr);
+			consumed += head;
+
+			if (!ready() || !alive(handle))
+				break;
+		}
+
+		break;
+	case STRING: // Fall through.
+	case JSON:
+		while (consumed < len) {
+			const Byte* begin = data + consumed;
+			const size_t rest = len - consumed;
+			const Byte* eos = (const Byte*)memchr(begin, '\0', std::min(rest, (size_t)NETWORK_MESSAGE_MAX_SIZE));
+			std::string truncated;
+			const char* str = nullptr;
+			size_t n = 0;
+			if (eos) { // The view is terminated by the EOS.
+				str = (const char*)begin;
+				n = (size_t)(eos - begin);
+			} else if (rest > NETWORK_MESSAGE_MAX_SIZE) { // Truncated, copy to terminate it.
+				truncated.assign((const char*)begin, NETWORK_MESSAGE_MAX_SIZE);
+				str = truncated.c_str();
+				n = truncated.length();
+			} else {
+				break;
+			}
+			consumed += n + 1;
+
+			received(str, n, addr);
+
+			if (!ready() || !alive(handle))
+				break;
+		}
+
+		break;
+	default:
+		assert(false && "Unknown data type.");
+
+		consumed = len;
+
+		break;
+	}
+
+	return consumed;
+}
+
+bool NetworkLibuv::websocket(void) const {
+	return _protocol == WEBSOCKET;
+}
+
+size_t NetworkLibuv::dispatchWebSocket(uv_stream_t* handle, Byte* data, size_t len, const char* addr) {
+	size_t consumed = 0;
+	if (!_webSockets[handle].handshaken) {
+		consumed = handshake(handle, data, len, addr);
+		if (!alive(handle))
+			return len;
+		if (!_webSockets[handle].handshaken)
+			return consumed;
+	}
+
+	while (consumed < len) {
+		const size_t n = unframe(handle, data + consumed, len - consumed, addr);
+		if (n == 0)
+			break;
+		consumed += n;
+
+		if (!ready() || !alive(handle))
+			break;
+	}
+
+	return consumed;
+}
+
+size_t NetworkLibuv::handshake(uv_stream_t* handle, const Byte* data, size_t len, const char* addr) {
+	std::string line;
+	Text::Dictionary fields;
+	const size_t n = networkParseHttpHead(data, len, line, fields);
+	if (n == 0) {
+		if (len <= NETWORK_WEBSOCKET_HANDSHAKE_MAX_SIZE)
+			return 0;
+
+		line.clear(); // Too long, fail.
+	}
+
+	auto field = [&] (const char* key, bool lower) -> std::string {
+		Text::Dictionary::const_iterator it = fields.find(key);
+		if (it == fields.end())
+			return "";
+
+		std::string ret = it->second;
+		if (lower)
+			Text::toLowerCase(ret);
+
+		return ret;
+	};
+	const Text::Array parts = Text::split(line, " ");
+
+	if (_wasBinded) {
+		const std::string key = field("sec-websocket-key", false);
+		const bool valid =
+			parts.size() == 3 && parts[0] == "GET" &&
+			field("upgrade", true) == "websocket" &&
+			field("connection", true).find("upgrade") != std::string::npos &&
+			field("sec-websocket-version", false) == "13" &&
+			!key.empty();
+
+		WriteRequest::Message msg;
+		if (valid) {
+			msg.payload = WriteRequest::Payload(new std::string(
+				"HTTP/1.1 101 Switching Protocols\r\n"
+				"Upgrade: websocket\r\n"
+				"Connection: Upgrade\r\n"
+				"Sec-WebSocket-Accept: " + networkWebSocketAccept(key) + "\r\n"
+				"\r\n"
+			));
+		} else {
+			msg.payload = WriteRequest::Payload(new std::string(
+				"HTTP/1.1 400 Bad Request\r\n"
+				"Sec-WebSocket-Version: 13\r\n"
+				"Content-Length: 0\r\n"
+				"\r\n"
+			));
+		}
+		push(handle, msg);
+		flush();
+
+		if (!valid) {
+			fprintf(stderr, "Network (0x%p) WebSocket handshaking error: %s.\n", (Network*)this, addr);
+
+			drop(handle);
+
+			return len;
+		}
+
+		_webSockets[handle].handshaken = true;
+		established(addr);
+	} else {
+		const bool valid =
+			parts.size() >= 2 && parts[1] == "101" &&
+			field("sec-websocket-accept", false) == _webSockets[handle].accept;
+		if (!valid) {
+			fprintf(stderr, "Network (0x%p) WebSocket handshaking error: %s.\n", (Network*)this, addr);
+
+			uv_read_stop(handle);
+			discard(handle);
+			_webSockets.erase(handle);
+			if (_connect) {
+				free(_connect);
+				_connect = nullptr;
+			}
+			if ((uv_tcp_t*)handle == _tcp) { // Closes the outcoming connection.
+				uv_close((uv_handle_t*)handle, [] (uv_handle_t* handle) -> void { free(handle); });
+				_tcp = nullptr;
+			}
+			_ready = FAILED;
+
+			established(nullptr);
+
+			return len;
+		}
+
+		_webSockets[handle].handshaken = true;
+		_ready = READY;
+		established(addr);
+	}
+
+	return n;
+}
+
+size_t NetworkLibuv::unframe(uv_stream_t* handle, Byte* data, size_t len, const char* addr) {
+	// Parse the head.
+	if (len < 2)
+		return 0;
+
+	const bool fin = !!(data[0] & 0x80);
+	const Byte opcode = (Byte)(data[0] & 0x0f);
+	const bool masked = !!(data[1] & 0x80);
+	UInt64 size = (UInt64)(data[1] & 0x7f);
+	size_t n = 2;
+	if (size == 126) {
+		if (len < 4)
+			return 0;
+
+		size = ((UInt64)data[2] << 8) | (UInt64)data[3];
+		n = 4;
+	} else if (size == 127) {
+		if (len < 10)
+			return 0;
+
+		size = 0;
+		for (int i = 0; i < 8; ++i)
+			size = (size << 8) | (UInt64)data[2 + i];
+		n = 10;
+	}
+
+	if (data[0] & 0x70) // Reserved bits without extension.
+		return fail(handle, 1002, len);
+	if (masked != _wasBinded) // Masked from client to server only.
+		return fail(handle, 1002, len);
+	if ((opcode & 0x08) && (!fin || size > 125)) // Control frame.
+		return fail(handle, 1002, len);
+	if (size > NETWORK_MESSAGE_MAX_SIZE)
+		return fail(handle, 1009, len);
+
+	Byte key[4] = { 0, 0, 0, 0 };
+	if (masked) {
+		if (len < n + 4)
+			return 0;
+
+		memcpy(key, data + n, 4);
+		n += 4;
+	}
+	if (len - n < size)
+		return 0;
+
+	// Unmask in place.
+	Byte* payload = data + n;
+	if (masked) {
+		for (size_t i = 0; i < (size_t)size; ++i)
+			payload[i] ^= key[i & 3];
+	}
+	n += (size_t)size;
+
+	// Handle the frame.
+	auto deliver_ = [&] (const char* ptr, size_t sz) -> void {
+		if (_dataType == STRING) { // Terminate it.
+			const std::string str(ptr, sz);
+			received(str.c_str(), str.length(), addr);
+		} else {
+			received(ptr, sz, addr);
+		}
+	};
+	WebSocket &ws = _webSockets[handle];
+	switch (opcode) {
+	case WebSocket::CONTINUATION: {
+			if (ws.opcode == WebSocket::CONTINUATION)
+				return fail(handle, 1002, len);
+			if (ws.message.length() + (size_t)size > NETWORK_MESSAGE_MAX_SIZE)
+				return fail(handle, 1009, len);
+
+			ws.message.append((const char*)payload, (size_t)size);
+			if (fin) {
+				std::string message;
+				std::swap(message, ws.message);
+				ws.opcode = WebSocket::CONTINUATION;
+
+				received(message.c_str(), message.length(), addr);
+			}
+		}
+
+		break;
+	case WebSocket::TEXT: // Fall through.
+	case WebSocket::BINARY:
+		if (ws.opcode != WebSocket::CONTINUATION)
+			return fail(handle, 1002, len);
+
+		if (fin) {
+			deliver_((const char*)payload, (size_t)size);
+		} else {
+			ws.opcode = opcode;
+			ws.message.assign((const char*)payload, (size_t)size);
+		}
+
+		break;
+	case WebSocket::CLOSE:
+		frame(handle, WebSocket::CLOSE, std::string((const char*)payload, std::min((size_t)size, (size_t)2))); // Echo the status code.
+		flush();
+		drop(handle);
+
+		return len;
+	case WebSocket::PING:
+		frame(handle, WebSocket::PONG, std::string((const char*)payload, (size_t)size));
+		flush();
+
+		break;
+	case WebSocket::PONG: // Do nothing.
+		break;
+	default:
+		return fail(handle, 1002, len);
+	}
+
+	return n;
+}
+
+void NetworkLibuv::frame(uv_stream_t* handle, Byte opcode, const std::string &payload) {
+	WriteRequest::Message msg;
+	msg.payload = WriteRequest::Payload(new std::string(payload));
+	networkWebSocketFrame(msg, opcode, !_wasBinded);
+	push(handle, msg);
+}
+
+size_t NetworkLibuv::fail(uv_stream_t* handle, UInt16 code, size_t len) {
+	fprintf(stderr, "Network (0x%p) WebSocket protocol error: %d.\n", (Network*)this, (int)code);
+
+	const char status[2] = { (char)(code >> 8), (char)(code & 0xff) };
+	frame(handle, WebSocket::CLOSE, std::string(status, 2));
+	flush();
+	drop(handle);
+
+	return len;
+}
+
+void NetworkLibuv::drop(uv_stream_t* handle) {
+	if (!_wasBinded)
+		uv_read_stop(handle);
+
+	onClosed(handle); // Closes the incoming connection.
+
+	if (!_wasBinded && (uv_tcp_t*)handle == _tcp) { // Closes the outcoming connection.
+		uv_close((uv_handle_t*)handle, [] (uv_handle_t* handle) -> void { free(handle); });
+		_tcp = nullptr;
+	}
+}
+
+char* NetworkLibuv::acquireReadBuffer(void) {
+	if (_readPool.empty()) {
+		char* slab = (char*)malloc(NETWORK_READ_BUFFER_SIZE * NETWORK_READ_BUFFER_SLAB_COUNT);
+		_readSlabs.push_back(slab);
+		for (int i = NETWORK_READ_BUFFER_SLAB_COUNT - 1; i >= 0; --i)
+			_readPool.push_back(slab + i * NETWORK_READ_BUFFER_SIZE);
+	}
+
+	char* buf = _readPool.back();
+	_readPool.pop_back();
+
+	return buf;
+}
+
+void NetworkLibuv::releaseReadBuffer(char* buf) {
+	_readPool.push_back(buf);
+}
+
+class Bytes* NetworkLibuv::takeRecvCache(uv_stream_t* handle) {
+	ReceivingCaches::iterator it = _recvCaches.find(handle);
+	if (it == _recvCaches.end())
+		return nullptr;
+
+	Bytes* result = it->second;
+	_recvCaches.erase(it);
+
+	return result;
+}
 
-	return _bytesCache;
+void NetworkLibuv::keepRecvCache(uv_stream_t* handle, class Bytes* receiving) {
+	_recvCaches[handle] = receiving;
 }
 
 class Json* NetworkLibuv::jsonCache(void) {
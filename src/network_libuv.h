@@ -17,7 +17,12 @@
 #	include "../lib/libuv/include/uv.h"
 #endif /* BITTY_NETWORK_ENABLED */
 #include <map>
+#include <memory>
 #include <vector>
+#if BITTY_MULTITHREAD_ENABLED
+#	include <atomic>
+#	include <thread>
+#endif /* BITTY_MULTITHREAD_ENABLED */
 
 /*
 ** {===========================================================================
@@ -30,17 +35,143 @@ class NetworkLibuv : public Network {
 public:
 	typedef std::vector<uv_tcp_t*> TcpClientHandles;
 
+	/**
+	 * @brief Pending messages of a stream, written by a single `uv_write` with
+	 *   one buffer for each size head, payload and EOS.
+	 */
+	struct WriteRequest {
+		typedef std::shared_ptr<std::string> Payload;
+
+		struct Message {
+			Byte frame[14]; // WebSocket frame head.
+			unsigned frameSize = 0;
+			BytesSize head = 0;
+			bool withHead = false;
+			Payload payload = nullptr;
+			bool withEos = false;
+		};
+		typedef std::vector<Message> Messages;
+
+		typedef std::vector<uv_buf_t> Buffers;
+
+		uv_write_t req;
+		NetworkLibuv* owner = nullptr;
+		uv_stream_t* handle = nullptr;
+		Messages messages;
+		Buffers buffers;
+
+		void clear(void);
+	};
+	typedef std::vector<WriteRequest*> WriteRequests;
+
+	/**
+	 * @brief State of a WebSocket connection.
+	 */
+	struct WebSocket {
+		enum Opcodes : Byte {
+			CONTINUATION = 0x0,
+			TEXT = 0x1,
+			BINARY = 0x2,
+			CLOSE = 0x8,
+			PING = 0x9,
+			PONG = 0xa
+		};
+
+		bool handshaken = false;
+		std::string accept; // Expected by client.
+		Byte opcode = CONTINUATION; // Of the fragmented message.
+		std::string message; // Fragments.
+	};
+	typedef std::map<uv_stream_t*, WebSocket> WebSockets;
+
 private:
 	typedef std::map<std::string, std::string> OptionDictionary;
 
+	typedef std::map<uv_stream_t*, class Bytes*> ReceivingCaches;
+	typedef std::vector<char*> ReadBuffers;
+
+#if BITTY_MULTITHREAD_ENABLED
+	/**
+	 * @brief Unbounded lock-free queue with a single producer and a single
+	 *   consumer.
+	 */
+	template<typename T> class Channel : public NonCopyable {
+	private:
+		struct Node {
+			T value;
+			std::atomic<Node*> next { nullptr };
+		};
+
+	private:
+		Node* _head = nullptr; // By the consumer.
+		Node* _tail = nullptr; // By the producer.
+
+	public:
+		Channel() {
+			_head = _tail = new Node();
+		}
+		~Channel() {
+			while (_head) {
+				Node* next = _head->next.load(std::memory_order_relaxed);
+				delete _head;
+				_head = next;
+			}
+		}
+
+		void push(T &&val) {
+			Node* node = new Node();
+			node->value = std::move(val);
+			_tail->next.store(node, std::memory_order_release);
+			_tail = node;
+		}
+		bool pop(T &val) {
+			Node* next = _head->next.load(std::memory_order_acquire);
+			if (!next)
+				return false;
+
+			val = std::move(next->value);
+			delete _head;
+			_head = next;
+
+			return true;
+		}
+	};
+
+	struct Event {
+		enum Types {
+			RECEIVED,
+			ESTABLISHED,
+			DISCONNECTED
+		};
+
+		Types type = RECEIVED;
+		std::string data;
+		std::string address;
+		bool failed = false;
+	};
+
+	struct Command {
+		enum Types {
+			SEND,
+			BROADCAST,
+			STOP
+		};
+
+		Types type = SEND;
+		WriteRequest::Payload payload = nullptr;
+		bool bytesWithSize = false;
+		bool withEos = false;
+	};
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
 	typedef std::function<bool(const Byte*, size_t, bool, bool)> PushHandler;
 
 private:
 	/**< States. */
 
-	bool _opened = false;
-	States _ready = IDLE;
-	int _shutting = 0;
+	Atomic<bool> _opened { false };
+	Atomic<States> _ready { IDLE };
+	Atomic<int> _shutting { 0 };
 	bool _binded = false, _wasBinded = false;
 	Protocols _protocol = NONE;
 
@@ -52,6 +183,7 @@ private:
 	DataTypes _dataType = BYTES;
 	bool _bytesWithSize = true;
 	int _timeoutMs = 1;
+	bool _threaded = false;
 
 	/**< Connection. */
 
@@ -62,7 +194,22 @@ private:
 	TcpClientHandles _tcpClients;
 	uv_connect_t* _connect = nullptr;
 
-	class Bytes* _recvCache = nullptr;
+	/**< Reading. */
+
+	ReadBuffers _readPool;
+	ReadBuffers _readSlabs;
+	ReceivingCaches _recvCaches;
+
+	/**< WebSocket. */
+
+	WebSockets _webSockets;
+	std::string _webSocketHost;
+	std::string _webSocketPath;
+
+	/**< Writing. */
+
+	WriteRequests _writeQueue;
+	WriteRequests _writePool;
 
 	/**< Callbacks. */
 
@@ -71,9 +218,17 @@ private:
 	DisconnectedHandler _dscnHandler;
 
 	std::string _stringCache;
-	class Bytes* _bytesCache = nullptr;
 	class Json* _jsonCache = nullptr;
 
+	/**< Threading. */
+
+#if BITTY_MULTITHREAD_ENABLED
+	std::thread _thread;
+	uv_async_t _wakeup;
+	Channel<Event> _inbound;  // From the I/O thread to the Lua thread.
+	Channel<Command> _outbound; // From the Lua thread to the I/O thread.
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
 public:
 	NetworkLibuv();
 	virtual ~NetworkLibuv() override;
@@ -113,8 +268,14 @@ public:
 
 	void onAccepted(uv_stream_t* handle, int status);
 	void onConnected(uv_connect_t* svr, int status);
+	void onAllocating(uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf);
+	void onRead(uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf);
 	void onReceived(uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf);
 	void onClosed(uv_stream_t* handle);
+	void onWritten(WriteRequest* req, int status);
+#if BITTY_MULTITHREAD_ENABLED
+	void onWakeup(void);
+#endif /* BITTY_MULTITHREAD_ENABLED */
 
 private:
 	void doOpen(bool withudp, bool withtcp, bool withws, bool toconn, bool tobind, const char* ipaddr, int port);
@@ -123,8 +284,40 @@ private:
 	void doPoll(int timeoutMs);
 	bool doPush(void* ptr, size_t sz, DataTypes y, PushHandler pusher) const;
 
-	class Bytes* recvCache(void);
-	class Bytes* bytesCache(void);
+	bool enqueue(uv_stream_t* handle, bool limitedSize, const WriteRequest::Payload &payload, bool bytesWithSize, bool withEos);
+	void push(uv_stream_t* handle, WriteRequest::Message &msg);
+	void flush(void);
+	void discard(uv_stream_t* handle);
+	WriteRequest* acquireWriteRequest(void);
+	void releaseWriteRequest(WriteRequest* req);
+
+	void start(void);
+	void stop(void);
+	void drain(void);
+#if BITTY_MULTITHREAD_ENABLED
+	bool post(Command::Types y, const Byte* buf, size_t len, bool bytesWithSize, bool withEos);
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+	void established(const char* addr /* nullable */);
+	void disconnected(const char* addr);
+	void received(const char* data, size_t len, const char* addr);
+	void deliver(const char* data, size_t len, const char* addr);
+
+	bool alive(uv_stream_t* handle) const;
+	size_t dispatch(uv_stream_t* handle, const Byte* data, size_t len, const char* addr);
+
+	bool websocket(void) const;
+	size_t dispatchWebSocket(uv_stream_t* handle, Byte* data, size_t len, const char* addr);
+	size_t handshake(uv_stream_t* handle, const Byte* data, size_t len, const char* addr);
+	size_t unframe(uv_stream_t* handle, Byte* data, size_t len, const char* addr);
+	void frame(uv_stream_t* handle, Byte opcode, const std::string &payload);
+	size_t fail(uv_stream_t* handle, UInt16 code, size_t len);
+	void drop(uv_stream_t* handle);
+	char* acquireReadBuffer(void);
+	void releaseReadBuffer(char* buf);
+
+	class Bytes* takeRecvCache(uv_stream_t* handle);
+	void keepRecvCache(uv_stream_t* handle, class Bytes* receiving);
 	class Json* jsonCache(void);
 };
 
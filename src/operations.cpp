@@ -69,7 +69,7 @@
 #endif /* OPERATIONS_BITTY_FILE_FILTER */
 #ifndef OPERATIONS_BITTY_FULL_FILE_FILTER
 #	define OPERATIONS_BITTY_FULL_FILE_FILTER { \
-			"Bitty project files (*." BITTY_PROJECT_EXT ", *." BITTY_TEXT_EXT ", *." BITTY_ZIP_EXT ")", "*." BITTY_PROJECT_EXT " *." BITTY_TEXT_EXT " *." BITTY_ZIP_EXT, \
+			"Bitty project files (*." BITTY_PROJECT_EXT ", *." BITTY_TEXT_EXT ", *." BITTY_ZIP_EXT ", *." BITTY_PACK_EXT ")", "*." BITTY_PROJECT_EXT " *." BITTY_TEXT_EXT " *." BITTY_ZIP_EXT " *." BITTY_PACK_EXT, \
 			"All files (*.*)", "*" \
 		}
 #endif /* OPERATIONS_BITTY_FULL_FILE_FILTER */
@@ -3051,6 +3051,8 @@ promise::Defer Operations::projectExport(class Renderer* rnd, Workspace* ws, con
 							preference = Archive::TXT;
 						else if (ext == BITTY_ZIP_EXT)
 							preference = Archive::ZIP;
+						else if (ext == BITTY_PACK_EXT)
+							preference = Archive::BIN;
 					}
 					if (Path::isParentOf(prj->path().c_str(), path.c_str())) {
 						df.reject();
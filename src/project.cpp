@@ -9,10 +9,12 @@
 */
 
 #include "archive.h"
+#include "audio.h"
 #include "bytes.h"
 #include "datetime.h"
 #include "editable.h"
 #include "filesystem.h"
+#include "font.h"
 #include "image.h"
 #include "loader.h"
 #include "map.h"
@@ -20,6 +22,60 @@
 #include "project.h"
 #include "sprite.h"
 #include "../lib/jpath/jpath.hpp"
+#if BITTY_MULTITHREAD_ENABLED
+#	include <thread>
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+/*
+** {===========================================================================
+** Macros and constants
+*/
+
+#ifndef PROJECT_PRELOAD_MAX_THREAD_COUNT
+#	define PROJECT_PRELOAD_MAX_THREAD_COUNT 8
+#endif /* PROJECT_PRELOAD_MAX_THREAD_COUNT */
+
+/* ===========================================================================} */
+
+/*
+** {===========================================================================
+** Utilities
+*/
+
+/**
+ * @brief Runs a job for each index in `[0, n)` on a pool of worker threads,
+ *   the calling thread takes part in as well.
+ */
+static void projectParallelFor(size_t n, const std::function<void(size_t)> &job) {
+#if BITTY_MULTITHREAD_ENABLED
+	size_t count = (size_t)std::thread::hardware_concurrency();
+	count = std::min(count, (size_t)PROJECT_PRELOAD_MAX_THREAD_COUNT);
+	count = std::min(count, n);
+	if (count <= 1) {
+		for (size_t i = 0; i < n; ++i)
+			job(i);
+
+		return;
+	}
+
+	std::atomic<size_t> next(0);
+	auto proc = [&next, n, &job] (void) -> void {
+		for (size_t i = next++; i < n; i = next++)
+			job(i);
+	};
+	std::vector<std::thread> workers;
+	for (size_t i = 1; i < count; ++i)
+		workers.push_back(std::thread(proc));
+	proc();
+	for (std::thread &worker : workers)
+		worker.join();
+#else /* BITTY_MULTITHREAD_ENABLED */
+	for (size_t i = 0; i < n; ++i)
+		job(i);
+#endif /* BITTY_MULTITHREAD_ENABLED */
+}
+
+/* ===========================================================================} */
 
 /*
 ** {===========================================================================
@@ -131,6 +187,8 @@ Text::Array Project::strategies(void) {
 			result.push_back("linear_canvas");
 		if ((strategy() & ANISOTROPIC_CANVAS) != NONE)
 			result.push_back("anisotropic_canvas");
+		if ((strategy() & PRELOAD) != NONE)
+			result.push_back("preload");
 	}
 
 	return result;
@@ -162,6 +220,103 @@ int Project::cleanup(Asset::Usages usage) {
 	return result;
 }
 
+int Project::preload(Asset::Usages usage) {
+	constexpr const int LEVEL_COUNT = 3; // Palettes and raw files, images, then sprites and maps.
+	typedef std::vector<Asset*> Assets;
+
+	int result = 0;
+
+	Assets levels[LEVEL_COUNT];
+	Assets sequential;
+	_assets.foreach(
+		[&] (Asset* &asset, int) -> void {
+			if (asset->object(usage))
+				return;
+
+			switch (asset->type()) {
+			case Sound::TYPE(): // Fall through.
+			case Font::TYPE():
+				sequential.push_back(asset); // Decoders of these are not thread-safe.
+
+				break;
+			default:
+				switch (asset->referencing()) {
+				case 0:
+					levels[0].push_back(asset);
+
+					break;
+				case Palette::TYPE():
+					levels[1].push_back(asset);
+
+					break;
+				default:
+					levels[2].push_back(asset);
+
+					break;
+				}
+
+				break;
+			}
+		}
+	);
+
+	bool intact = true; // Whether all references are ready, otherwise it falls back to load on the calling thread.
+	for (int l = 0; l < LEVEL_COUNT; ++l) {
+		Assets &assets = levels[l];
+		if (assets.empty())
+			continue;
+
+		if (l == LEVEL_COUNT - 1 && renderer()) {
+			_assets.foreach(
+				[&] (Asset* &asset, int) -> void {
+					if (asset->type() == Image::TYPE() && !asset->texture(usage)) // Uploads on the calling thread.
+						intact = false;
+				}
+			);
+		}
+
+		if (!intact) {
+			for (Asset* asset : assets) {
+				if (asset->load(usage))
+					++result;
+			}
+
+			continue;
+		}
+
+		std::vector<Bytes::Ptr> bufs;
+		for (Asset* asset : assets) { // Archive access stays on the calling thread.
+			Bytes::Ptr buf(Bytes::create());
+			if (asset->toBytes(buf.get()))
+				buf->poke(0);
+			else
+				buf = nullptr;
+			bufs.push_back(buf);
+		}
+
+		std::vector<char> loaded(assets.size(), false);
+		projectParallelFor(
+			assets.size(),
+			[&] (size_t i) -> void {
+				if (bufs[i])
+					loaded[i] = assets[i]->load(usage, bufs[i].get(), nullptr, false);
+			}
+		);
+		for (size_t i = 0; i < assets.size(); ++i) {
+			if (loaded[i])
+				++result;
+			else
+				intact = false;
+		}
+	}
+	for (Asset* asset : sequential) {
+		if (asset->load(usage))
+			++result;
+	}
+
+	return result;
+}
+
 bool Project::load(const char* strpath) {
 	archive(nullptr);
 
@@ -226,6 +381,85 @@ bool Project::save(const char* path_, bool redirect, ErrorHandler error) {
 	if (asset)
 		asset->prepare(Asset::EDITING, true);
 
+	const bool changed = path() != path_;
+
+	do { // Rewrite changed entries only when saving to the same place.
+		if (changed || path().empty())
+			break;
+
+		Archive* arch = nullptr;
+		if (!Path::existsDirectory(path().c_str())) {
+			if (!Path::existsFile(path().c_str()))
+				break;
+			arch = archive(Stream::READ);
+			if (!arch || arch->format() != (Archive::Formats)preference())
+				break;
+		}
+
+		typedef std::pair<Asset*, Bytes::Ptr> Change;
+		std::vector<Change> changes;
+		bool complete = true;
+		_assets.foreach(
+			[&] (Asset* &asset_, int) -> void {
+				if (!complete)
+					return;
+
+				Editable* editor = asset_->editor();
+				if (editor)
+					editor->flush();
+
+				const bool exists = asset_->exists();
+				if (exists && !asset_->object(Asset::EDITING))
+					return; // Not touched since loaded.
+				if (exists && editor && !asset_->dirty() && asset_ != asset)
+					return; // Without unsaved modification.
+
+				Bytes::Ptr buf(Bytes::create());
+				bool saved = asset_->object(Asset::EDITING) && asset_->save(Asset::EDITING, buf.get());
+				if (!saved)
+					saved = asset_->object(Asset::RUNNING) && asset_->save(Asset::RUNNING, buf.get());
+				if (!saved) {
+					complete = false; // Let the full saving report it.
+
+					return;
+				}
+				buf->poke(0);
+				if (exists && asset_->persisted(buf.get()))
+					return; // Serialized to identical content.
+
+				changes.push_back(std::make_pair(asset_, buf));
+			}
+		);
+		if (!complete)
+			break;
+		if (!changes.empty() && arch && !arch->removable())
+			break; // Cannot replace entries in place, eg. ZIP; FIXME: append changed entries to ZIP and compact it in the background instead of a full rewrite.
+
+		for (Change &change : changes) {
+			Asset* asset_ = change.first;
+			if (!asset_->fromBytes(change.second.get())) {
+				const std::string entry = asset_->entry().name();
+				if (error) {
+					std::string msg = "Cannot save to: ";
+					msg += entry;
+					msg += ".";
+					error(msg.c_str());
+				} else {
+					fprintf(stderr, "Cannot save to: %s.\n", entry.c_str());
+				}
+			}
+
+			Platform::idle();
+		}
+		if (!changes.empty())
+			archive(nullptr); // Flush.
+
+		if (asset)
+			asset->finish(Asset::EDITING, true);
+
+		return true;
+	} while (false);
+
 	std::map<std::string, Bytes::Ptr> cache;
 	_assets.foreach(
 		[&] (Asset* &asset_, int) -> void {
@@ -255,8 +489,6 @@ bool Project::save(const char* path_, bool redirect, ErrorHandler error) {
 		}
 	);
 
-	const bool changed = path() != path_;
-
 	if (path().empty() || redirect)
 		path(path_);
 
@@ -383,6 +615,8 @@ bool Project::parse(void) {
 				strategy((Strategies)(strategy() | LINEAR_CANVAS));
 			else if (s == "anisotropic_canvas")
 				strategy((Strategies)(strategy() | ANISOTROPIC_CANVAS));
+			else if (s == "preload")
+				strategy((Strategies)(strategy() | PRELOAD));
 		}
 	}
 
@@ -422,6 +656,8 @@ bool Project::serialize(void) {
 			strategies.push_back("linear_canvas");
 		if ((strategy() & ANISOTROPIC_CANVAS) != NONE)
 			strategies.push_back("anisotropic_canvas");
+		if ((strategy() & PRELOAD) != NONE)
+			strategies.push_back("preload");
 		if (!strategies.empty())
 			Jpath::set(doc, doc, strategies, "strategies");
 	}
@@ -55,7 +55,8 @@ public:
 		NONE = 0,
 		BATCH_MAP = 1 << 0,
 		LINEAR_CANVAS = 1 << 1,
-		ANISOTROPIC_CANVAS = 1 << 2
+		ANISOTROPIC_CANVAS = 1 << 2,
+		PRELOAD = 1 << 3
 	};
 
 	typedef std::function<void(const char*)> ErrorHandler;
@@ -127,6 +128,15 @@ public:
 	 * @brief Cleans up the project for a specific usage.
 	 */
 	int cleanup(Asset::Usages usage);
+	/**
+	 * @brief Loads all assets for a specific usage ahead of time. Assets are
+	 *   read on the calling thread, then decoded on worker threads in the
+	 *   order of references; textures, sounds and fonts are made on the
+	 *   calling thread.
+	 *
+	 * @return The count of loaded assets.
+	 */
+	int preload(Asset::Usages usage);
 
 	/**
 	 * @brief Loads project data from a specific path.
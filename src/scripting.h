@@ -25,6 +25,9 @@
 #ifndef SCRIPTING_UPDATE_FUNCTION_NAME
 #	define SCRIPTING_UPDATE_FUNCTION_NAME "update"
 #endif /* SCRIPTING_UPDATE_FUNCTION_NAME */
+#ifndef SCRIPTING_FIXED_UPDATE_FUNCTION_NAME
+#	define SCRIPTING_FIXED_UPDATE_FUNCTION_NAME "fixedUpdate"
+#endif /* SCRIPTING_FIXED_UPDATE_FUNCTION_NAME */
 #ifndef SCRIPTING_QUIT_FUNCTION_NAME
 #	define SCRIPTING_QUIT_FUNCTION_NAME "quit"
 #endif /* SCRIPTING_QUIT_FUNCTION_NAME */
@@ -175,6 +175,12 @@ void ScriptingLua::finish(void) {
 
 	clearRecords();
 
+	do {
+		LockGuard<decltype(_statisticsLock)> guard(_statisticsLock);
+
+		_statistics.clear();
+	} while (false);
+
 	do {
 		LockGuard<decltype(_lock)> guard(_lock);
 
@@ -182,6 +188,9 @@ void ScriptingLua::finish(void) {
 
 		_code = LUA_OK;
 		_delta = 0;
+		_accumulator = 0;
+		_overruns = 0;
+		_overrunStamp = 0;
 		_scope.clear();
 		_activity = 0;
 
@@ -200,6 +209,8 @@ void ScriptingLua::finish(void) {
 
 		if (_update)
 			_update = nullptr;
+		if (_fixedUpdate)
+			_fixedUpdate = nullptr;
 		if (_quit)
 			_quit = nullptr;
 		if (_focusLost)
@@ -213,6 +224,8 @@ void ScriptingLua::finish(void) {
 
 		_fps = 0;
 
+		_fixedStep = 0;
+
 		if (_timeout >= 0)
 			_timeout = SCRIPTING_LUA_TIMEOUT_NANOSECONDS;
 
@@ -242,6 +255,9 @@ bool ScriptingLua::setup(void) {
 			return false;
 		}
 
+		if ((prj->strategy() & Project::PRELOAD) != Project::NONE)
+			prj->preload(Asset::RUNNING);
+
 		main->prepare(Asset::RUNNING, true);
 		Object::Ptr obj = main->object(Asset::RUNNING);
 		if (!obj) {
@@ -325,6 +341,10 @@ bool ScriptingLua::setup(void) {
 		Lua::read(_L, _update);
 		Lua::pop(_L);
 
+		Lua::getGlobal(_L, SCRIPTING_FIXED_UPDATE_FUNCTION_NAME);
+		Lua::read(_L, _fixedUpdate);
+		Lua::pop(_L);
+
 		Lua::getGlobal(_L, SCRIPTING_QUIT_FUNCTION_NAME);
 		Lua::read(_L, _quit);
 		Lua::pop(_L);
@@ -383,7 +403,8 @@ bool ScriptingLua::cycle(double delta) {
 	if (!_L)
 		return false;
 
-	if (!_update || !_update->valid())
+	const bool fixed = _fixedUpdate && _fixedUpdate->valid();
+	if (!fixed && (!_update || !_update->valid()))
 		return false;
 
 	if (_primitives)
@@ -395,6 +416,39 @@ bool ScriptingLua::cycle(double delta) {
 		impl->_code = check(L, Lua::call(L, *impl->_update, impl->_delta));
 		assert(Lua::getTop(L) == 0 && "Polluted Lua stack.");
 	};
+	if (fixed) {
+		// Calls `fixedUpdate(step)` zero or more times to catch up with the elapsed
+		// time, then `update(delta, alpha)`, where `alpha` is the remaining fraction
+		// of a step for interpolation.
+		func = [] (lua_State* L, void* ud) -> void {
+			ScriptingLua* impl = (ScriptingLua*)ud;
+
+			const double step = impl->fixedStep();
+			impl->_accumulator += impl->_delta;
+			int steps = 0;
+			while (impl->_accumulator >= step) {
+				if (steps++ >= SCRIPTING_LUA_FIXED_STEP_MAX_COUNT) {
+					impl->_accumulator = std::fmod(impl->_accumulator, step); // Drop the steps which cannot catch up.
+					++impl->_overruns;
+
+					break;
+				}
+
+				impl->_code = check(L, Lua::call(L, *impl->_fixedUpdate, step));
+				assert(Lua::getTop(L) == 0 && "Polluted Lua stack.");
+				if (impl->_code != LUA_OK)
+					return;
+
+				impl->_accumulator -= step;
+			}
+
+			if (impl->_update && impl->_update->valid()) {
+				const double alpha = impl->_accumulator / step;
+				impl->_code = check(L, Lua::call(L, *impl->_update, impl->_delta, alpha));
+				assert(Lua::getTop(L) == 0 && "Polluted Lua stack.");
+			}
+		};
+	}
 #if BITTY_DEBUG_ENABLED
 	int ret = LUA_OK;
 	try {
@@ -427,6 +481,26 @@ bool ScriptingLua::cycle(double delta) {
 
 	sync(delta);
 
+	if (fixed) {
+		const long long now = DateTime::ticks();
+		if (_overrunStamp == 0) {
+			_overrunStamp = now;
+		} else if (now - _overrunStamp >= SCRIPTING_LUA_OVERRUN_REPORT_INTERVAL_NANOSECONDS) {
+			if (_overruns > 0) {
+				const std::string msg = Text::cformat(
+					_overruns == 1 ?
+						"Overran %u frame in %g seconds." :
+						"Overran %u frames in %g seconds.",
+					_overruns, DateTime::toSeconds(now - _overrunStamp)
+				);
+				observer()->warn(msg.c_str());
+			}
+
+			_overruns = 0;
+			_overrunStamp = now;
+		}
+	}
+
 	return true;
 }
 
@@ -663,7 +737,9 @@ bool ScriptingLua::run(void) {
 				const double expected = 1.0 / impl->_frameRate;
 				const double rest = expected - elapsed;
 				if (rest > 0)
-					DateTime::sleep((int)(rest * 1000));
+					DateTime::wait(DateTime::fromSeconds(rest));
+				else if (impl->_fixedUpdate && impl->_fixedUpdate->valid())
+					++impl->_overruns;
 			}
 		}
 
@@ -867,6 +943,26 @@ int ScriptingLua::getRecords(RecordGetter get) const {
 	return (int)_records.count();
 }
 
+void ScriptingLua::setStatistics(const char* key, const char* val) {
+	LockGuard<decltype(_statisticsLock)> guard(_statisticsLock);
+
+	if (val)
+		_statistics[key] = val;
+	else
+		_statistics.erase(key);
+}
+
+int ScriptingLua::getStatistics(StatisticsGetter get) const {
+	LockGuard<decltype(_statisticsLock)> guard(_statisticsLock);
+
+	if (get) {
+		for (const Text::Dictionary::value_type &kv : _statistics)
+			get(kv.first.c_str(), kv.second.c_str());
+	}
+
+	return (int)_statistics.size();
+}
+
 bool ScriptingLua::getVariable(const char* name_, const char* &type_, Variant* &var) const {
 	if (!name_)
 		return false;
@@ -1026,6 +1122,17 @@ double ScriptingLua::delta(void) const {
 	return _delta;
 }
 
+double ScriptingLua::fixedStep(void) const {
+	if (_fixedStep > 0)
+		return _fixedStep;
+
+	return 1.0 / _frameRate;
+}
+
+void ScriptingLua::fixedStep(double val) {
+	_fixedStep = std::max(val, 0.0);
+}
+
 void ScriptingLua::gc(void) {
 	Lua::gc(_L);
 }
@@ -27,6 +27,12 @@
 #ifndef SCRIPTING_LUA_TIMEOUT_NANOSECONDS
 #	define SCRIPTING_LUA_TIMEOUT_NANOSECONDS 10000000000ll /* 10 seconds. */
 #endif /* SCRIPTING_LUA_TIMEOUT_NANOSECONDS */
+#ifndef SCRIPTING_LUA_FIXED_STEP_MAX_COUNT
+#	define SCRIPTING_LUA_FIXED_STEP_MAX_COUNT 5
+#endif /* SCRIPTING_LUA_FIXED_STEP_MAX_COUNT */
+#ifndef SCRIPTING_LUA_OVERRUN_REPORT_INTERVAL_NANOSECONDS
+#	define SCRIPTING_LUA_OVERRUN_REPORT_INTERVAL_NANOSECONDS 3000000000ll /* 3 seconds. */
+#endif /* SCRIPTING_LUA_OVERRUN_REPORT_INTERVAL_NANOSECONDS */
 
 /* ===========================================================================} */
 
@@ -57,10 +63,12 @@ protected:
 	bool _debugRealNumberPrecisely = false;                 // By the Lua thread.
 	long long _timeout = SCRIPTING_LUA_TIMEOUT_NANOSECONDS; // By the Lua thread.
 	unsigned _frameRate = BITTY_ACTIVE_FRAME_RATE;          // By the Lua thread.
+	double _fixedStep = 0.0;                                // By the Lua thread.
 
 	Atomic<unsigned> _fps;                                  // By the Lua, graphics threads.
 
 	Lua::Function::Ptr _update = nullptr;                   // By the Lua thread.
+	Lua::Function::Ptr _fixedUpdate = nullptr;              // By the Lua thread.
 	Lua::Function::Ptr _quit = nullptr;                     // By the Lua thread.
 	Lua::Function::Ptr _focusLost = nullptr;                // By the Lua thread.
 	Lua::Function::Ptr _focusGained = nullptr;              // By the Lua thread.
@@ -80,9 +88,14 @@ protected:
 
 	Breakpoints _breakpoints;                               // By the Lua, graphics threads.
 	Records _records;                                       // By the Lua, graphics threads.
+	Text::Dictionary _statistics;                           // By the Lua, graphics threads.
+	mutable RecursiveMutex _statisticsLock;                 // By the Lua, graphics threads.
 
 	int _code = 0;                                          // By the Lua thread.
 	double _delta = 0.0;                                    // By the Lua thread.
+	double _accumulator = 0.0;                              // By the Lua thread.
+	unsigned _overruns = 0;                                 // By the Lua thread.
+	long long _overrunStamp = 0;                            // By the Lua thread.
 	Scope _scope;                                           // By the Lua thread.
 	long long _activity = 0;                                // By the Lua thread.
 
@@ -154,6 +167,9 @@ public:
 
 	virtual int getRecords(RecordGetter access) const override;
 
+	virtual void setStatistics(const char* key, const char* val) override;
+	virtual int getStatistics(StatisticsGetter access) const override;
+
 	virtual bool getVariable(const char* name, const char* &type, Variant* &var) const override;
 	virtual bool setVariable(const char* name, const Variant* var) const override;
 
@@ -165,6 +181,16 @@ public:
 
 	double delta(void) const;
 
+	/**
+	 * @brief Gets the step of `fixedUpdate` in seconds, follows the frame rate
+	 *   if it's not specified.
+	 */
+	double fixedStep(void) const;
+	/**
+	 * @param[in] val Zero to follow the frame rate.
+	 */
+	void fixedStep(double val);
+
 	virtual void gc(void) override;
 
 	bool addUpdatable(class Updatable* ptr);
@@ -32,6 +32,7 @@
 #include "web.h"
 #include "window.h"
 #include "resource/inline_resource.h"
+#include "../lib/rapidjson/include/rapidjson/memorystream.h"
 #define SDL_MAIN_HANDLED
 #include <SDL.h>
 #if defined BITTY_OS_HTML
@@ -47,6 +48,13 @@ static_assert(sizeof(Int64) == sizeof(lua_Integer), "Wrong size.");
 static_assert(sizeof(UInt64) == sizeof(lua_Unsigned), "Wrong size.");
 static_assert(sizeof(Double) == sizeof(lua_Number), "Wrong size.");
 
+#ifndef SCRIPTING_LUA_VALUE_POOL_MAX_SIZE
+#	define SCRIPTING_LUA_VALUE_POOL_MAX_SIZE 1024
+#endif /* SCRIPTING_LUA_VALUE_POOL_MAX_SIZE */
+#ifndef SCRIPTING_LUA_JSON_CHUNK_SIZE
+#	define SCRIPTING_LUA_JSON_CHUNK_SIZE 256
+#endif /* SCRIPTING_LUA_JSON_CHUNK_SIZE */
+
 /* ===========================================================================} */
 
 /*
@@ -97,6 +105,108 @@ LUA_READ_OBJ(Bytes)
 LUA_WRITE_OBJ(Bytes)
 LUA_WRITE_OBJ_CONST(Bytes)
 
+/**
+ * @brief Typed view over `Bytes`, elements are accessed in native endian.
+ */
+struct BytesView {
+	enum Types : Enum {
+		BYTE,
+		INT16,
+		UINT16,
+		INT32,
+		UINT32,
+		SINGLE,
+		DOUBLE
+	};
+
+	Bytes::Ptr bytes = nullptr;
+	Types type = BYTE;
+	size_t offset = 0; // In bytes.
+	size_t limit = std::numeric_limits<size_t>::max(); // In elements, max for till the end.
+
+	size_t size(void) const {
+		switch (type) {
+		case BYTE: return sizeof(Byte);
+		case INT16: return sizeof(Int16);
+		case UINT16: return sizeof(UInt16);
+		case INT32: return sizeof(Int32);
+		case UINT32: return sizeof(UInt32);
+		case SINGLE: return sizeof(Single);
+		case DOUBLE: return sizeof(Double);
+		}
+
+		return sizeof(Byte);
+	}
+	size_t count(void) const {
+		if (!bytes || offset >= bytes->count())
+			return 0;
+
+		const size_t n = (bytes->count() - offset) / size();
+
+		return std::min(n, limit);
+	}
+	Byte* pointer(void) const {
+		if (!bytes || offset >= bytes->count())
+			return nullptr;
+
+		return bytes->pointer() + offset;
+	}
+
+	template<typename T> static T load(const Byte* ptr, size_t index) {
+		T ret;
+		memcpy(&ret, ptr + index * sizeof(T), sizeof(T));
+
+		return ret;
+	}
+	template<typename T> static void store(Byte* ptr, size_t index, double val) {
+		T val_ = std::is_integral<T>::value ?
+			(T)Math::clamp(val, (double)std::numeric_limits<T>::lowest(), (double)std::numeric_limits<T>::max()) :
+			(T)val;
+		memcpy(ptr + index * sizeof(T), &val_, sizeof(T));
+	}
+
+	template<typename Handler> void visit(Handler handler) const {
+		switch (type) {
+		case BYTE: handler(Byte()); break;
+		case INT16: handler(Int16()); break;
+		case UINT16: handler(UInt16()); break;
+		case INT32: handler(Int32()); break;
+		case UINT32: handler(UInt32()); break;
+		case SINGLE: handler(Single()); break;
+		case DOUBLE: handler(Double()); break;
+		}
+	}
+
+	double get(size_t index) const {
+		double ret = 0;
+		const Byte* ptr = pointer();
+		visit(
+			[&] (auto tag) -> void {
+				typedef decltype(tag) T;
+
+				ret = (double)load<T>(ptr, index);
+			}
+		);
+
+		return ret;
+	}
+	void set(size_t index, double val) const {
+		Byte* ptr = pointer();
+		visit(
+			[&] (auto tag) -> void {
+				typedef decltype(tag) T;
+
+				store<T>(ptr, index, val);
+			}
+		);
+	}
+};
+
+LUA_CHECK(BytesView)
+LUA_READ(BytesView)
+LUA_WRITE(BytesView)
+LUA_WRITE_CONST(BytesView)
+
 /**< Color. */
 
 LUA_CHECK(Color)
@@ -641,6 +751,10 @@ static int write_(lua_State* L, const Variant* val, References &refs) {
 
 					setTable(L, key);
 				}
+			} else {
+				refs.remove(ref);
+
+				break; // Unsupported object, write as nil.
 			}
 
 			refs.remove(ref);
@@ -928,6 +1042,298 @@ template<> int write(lua_State* L, rapidjson::Document &doc) {
 	return write_(L, val, false);
 }
 
+/**
+ * @brief SAX handler which builds Lua values on the stack directly from JSON
+ *   text. Elements of a container are collected on the stack, then moved into
+ *   a table created with the known size when the container ends, or when they
+ *   fill a chunk.
+ */
+class JsonTableHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JsonTableHandler> {
+private:
+	struct Frame {
+		bool array = false;
+		int table = 0;          // Absolute stack index of the table, zero before it's created.
+		int pending = 0;        // Count of elements, or key-value pairs on the stack.
+		lua_Integer stored = 0; // Count of elements moved into the table.
+	};
+	typedef std::vector<Frame> Frames;
+
+private:
+	lua_State* _L = nullptr;
+	bool _allowNull = false;
+	Frames _frames;
+
+public:
+	JsonTableHandler(lua_State* L, bool allowNull) : _L(L), _allowNull(allowNull) {
+	}
+
+	bool Null(void) {
+		if (!reserve())
+			return false;
+
+		if (_allowNull) {
+			const LightUserdata Null;
+			write(_L, Null);
+		} else {
+			write(_L, nullptr);
+		}
+
+		return added();
+	}
+	bool Bool(bool b) {
+		if (!reserve())
+			return false;
+
+		lua_pushboolean(_L, b ? 1 : 0);
+
+		return added();
+	}
+	bool Int(int i) {
+		return Int64(i);
+	}
+	bool Uint(unsigned u) {
+		return Int64(u);
+	}
+	bool Int64(int64_t i) {
+		if (!reserve())
+			return false;
+
+		lua_pushinteger(_L, (lua_Integer)i);
+
+		return added();
+	}
+	bool Uint64(uint64_t u) {
+		if (u > (uint64_t)std::numeric_limits<lua_Integer>::max())
+			return Double((double)u);
+
+		return Int64((int64_t)u);
+	}
+	bool Double(double d) {
+		if (!reserve())
+			return false;
+
+		lua_pushnumber(_L, (lua_Number)d);
+
+		return added();
+	}
+	bool String(const char* str, rapidjson::SizeType len, bool /* copy */) {
+		if (!reserve())
+			return false;
+
+		lua_pushlstring(_L, str, len);
+
+		return added();
+	}
+	bool StartObject(void) {
+		Frame frame;
+		frame.array = false;
+		_frames.push_back(frame);
+
+		return true;
+	}
+	bool Key(const char* str, rapidjson::SizeType len, bool /* copy */) {
+		if (!reserve())
+			return false;
+
+		lua_pushlstring(_L, str, len);
+
+		return true;
+	}
+	bool EndObject(rapidjson::SizeType /* memberCount */) {
+		return close();
+	}
+	bool StartArray(void) {
+		Frame frame;
+		frame.array = true;
+		_frames.push_back(frame);
+
+		return true;
+	}
+	bool EndArray(rapidjson::SizeType /* elementCount */) {
+		return close();
+	}
+
+private:
+	bool reserve(void) {
+		return !!lua_checkstack(_L, 1);
+	}
+	bool added(void) {
+		if (_frames.empty())
+			return true; // The root value.
+
+		Frame &frame = _frames.back();
+		if (++frame.pending >= SCRIPTING_LUA_JSON_CHUNK_SIZE)
+			return flush(frame);
+
+		return true;
+	}
+	bool flush(Frame &frame) {
+		const int slots = frame.array ? frame.pending : frame.pending * 2;
+		if (!frame.table) {
+			if (!reserve())
+				return false;
+
+			lua_createtable(_L, frame.array ? frame.pending : 0, frame.array ? 0 : frame.pending);
+			lua_rotate(_L, -(slots + 1), 1); // Move the table under the pending values.
+			frame.table = lua_absindex(_L, -(slots + 1));
+		}
+		if (frame.array) {
+			for (int i = frame.pending; i >= 1; --i)
+				lua_rawseti(_L, frame.table, frame.stored + i);
+			frame.stored += frame.pending;
+		} else {
+			if (!lua_checkstack(_L, 2))
+				return false;
+
+			const int pairs = lua_absindex(_L, -slots);
+			for (int i = 0; i < frame.pending; ++i) { // In document order, so that the last duplicate key wins.
+				lua_pushvalue(_L, pairs + i * 2);
+				lua_pushvalue(_L, pairs + i * 2 + 1);
+				lua_rawset(_L, frame.table);
+			}
+			lua_pop(_L, slots);
+		}
+		frame.pending = 0;
+
+		return true;
+	}
+	bool close(void) {
+		if (!flush(_frames.back()))
+			return false;
+		_frames.pop_back();
+
+		return added(); // The table is a value of its parent now.
+	}
+};
+
+/**
+ * @brief Decodes JSON text into a Lua value on the stack without an
+ *   intermediate DOM.
+ *
+ * @return The count of pushed values, zero for failure.
+ */
+static int decodeJson(lua_State* L, const char* json, size_t len, bool allowNull, std::string* err /* nullable */) {
+	const int top = getTop(L);
+
+	rapidjson::MemoryStream stream(json, len);
+	JsonTableHandler handler(L, allowNull);
+	rapidjson::Reader reader;
+	const rapidjson::ParseResult ret = reader.Parse(stream, handler);
+	if (!ret) {
+		if (err) {
+			*err = rapidjson::GetParseError_En(ret.Code());
+			*err += " (";
+			*err += Text::toString((UInt32)ret.Offset());
+			*err += ")";
+		}
+
+		lua_settop(L, top);
+
+		return 0;
+	}
+
+	return getTop(L) - top;
+}
+
+template<typename Writer> static void encodeJson_(lua_State* L, Writer &writer, Index idx, References &refs) {
+	switch (typeOf(L, idx)) {
+	case LUA_TNUMBER:
+		if (isInteger(L, idx)) {
+			lua_Integer data = 0;
+			read(L, data, idx);
+			writer.Int64(data);
+		} else {
+			lua_Number data = 0;
+			read(L, data, idx);
+			if (std::isfinite(data))
+				writer.Double(data);
+			else
+				writer.Null(); // JSON has no NaN nor infinity.
+		}
+
+		break;
+	case LUA_TBOOLEAN:
+		writer.Bool(!!lua_toboolean(L, idx));
+
+		break;
+	case LUA_TSTRING: {
+			size_t len = 0;
+			const char* data = lua_tolstring(L, idx, &len);
+			writer.String(data, (rapidjson::SizeType)len);
+		}
+
+		break;
+	case LUA_TTABLE: {
+			const uintptr_t ref = (uintptr_t)lua_topointer(L, idx);
+			if (refs.contains(ref)) {
+				error(L, "Unsupported reference cycle.");
+
+				break;
+			}
+			refs.add(ref);
+
+			const int tbl = lua_absindex(L, idx);
+			if (isArray(L, tbl)) {
+				writer.StartArray();
+
+				const lua_Unsigned n = len(L, tbl);
+				for (lua_Integer i = 1; i <= (lua_Integer)n; ++i) { // 1-based.
+					lua_rawgeti(L, tbl, i);
+					encodeJson_(L, writer, Index(-1), refs);
+					pop(L);
+				}
+
+				writer.EndArray();
+			} else {
+				writer.StartObject();
+
+				write(L, nullptr); // Before: ...table (top); after: ...table, nil (top).
+				while (next(L, tbl)) { // Stack: table, key, value (top).
+					const int y = typeOf(L, -2);
+					if (y == LUA_TSTRING || y == LUA_TNUMBER) {
+						lua_pushvalue(L, -2); // Convert a copy, to keep the key intact for `next`.
+						size_t len = 0;
+						const char* k = lua_tolstring(L, -1, &len);
+						writer.Key(k, (rapidjson::SizeType)len);
+						pop(L);
+
+						encodeJson_(L, writer, Index(-1), refs);
+					}
+
+					pop(L); // Pop value, leaving the key.
+				} // Stack: table (top).
+
+				writer.EndObject();
+			}
+
+			refs.remove(ref);
+		}
+
+		break;
+	default: // Nil, `Json.Null` and unsupported values.
+		writer.Null();
+
+		break;
+	}
+}
+
+/**
+ * @brief Encodes a Lua value into JSON text without an intermediate DOM.
+ */
+static void encodeJson(lua_State* L, Index idx, std::string &json, bool pretty) {
+	References refs;
+	rapidjson::StringBuffer buffer;
+	if (pretty) {
+		rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+		writer.SetIndent(' ', 2);
+		encodeJson_(L, writer, idx, refs);
+	} else {
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+		encodeJson_(L, writer, idx, refs);
+	}
+	json.assign(buffer.GetString(), buffer.GetSize());
+}
+
 /**< Walker. */
 
 template<typename Func, typename ...Args> int call(Walker::Blocking &ret, lua_State* L, const Func &func, const Args &...args) {
@@ -1132,6 +1538,33 @@ void open(class Executable* exec) {
 	open_Standard(L);
 }
 
+void worker(lua_State* L) {
+	// Builtin, without the package and debug libraries.
+	req(
+		L,
+		array(
+			luaL_Reg{ LUA_GNAME, luaopen_base },
+			luaL_Reg{ LUA_COLIBNAME, luaopen_coroutine },
+			luaL_Reg{ LUA_TABLIBNAME, luaopen_table },
+			luaL_Reg{ LUA_STRLIBNAME, luaopen_string },
+			luaL_Reg{ LUA_MATHLIBNAME, luaopen_math },
+			luaL_Reg{ LUA_UTF8LIBNAME, luaopen_utf8 },
+			luaL_Reg{ nullptr, nullptr }
+		)
+	);
+
+	// Standard, without `exit`.
+	reg(
+		L,
+		array(
+			luaL_Reg{ "print", print },
+			luaL_Reg{ "warn", warn },
+			luaL_Reg{ "collectgarbage", collectgarbage },
+			luaL_Reg{ nullptr, nullptr }
+		)
+	);
+}
+
 }
 
 }
@@ -1193,6 +1626,73 @@ static void open_LightUserdata(lua_State* L) {
 	pop(L);
 }
 
+/**< Value pool. */
+
+template<typename Class> static int ValuePool_table(lua_State* L) { // Before: ...; after: ...pool (top).
+	static const char KEY = '\0'; // One pool per value type per state, pooled objects are stacked in the array part and marked in the hash part.
+
+	if (lua_rawgetp(L, LUA_REGISTRYINDEX, &KEY) != LUA_TTABLE) {
+		pop(L);
+
+		newTable(L, SCRIPTING_LUA_VALUE_POOL_MAX_SIZE);
+		push(L, -1);
+		lua_rawsetp(L, LUA_REGISTRYINDEX, &KEY);
+	}
+
+	return getTop(L);
+}
+
+template<typename Class> static Class* ValuePool_acquire(lua_State* L) { // Before: ...; after: ...obj (top).
+	const int pool = ValuePool_table<Class>(L);
+	const lua_Unsigned n = len(L, pool);
+	if (n > 0) {
+		lua_rawgeti(L, pool, (lua_Integer)n);
+		lua_pushnil(L);
+		lua_rawseti(L, pool, (lua_Integer)n);
+		push(L, -1);
+		lua_pushnil(L);
+		lua_rawset(L, pool); // Unmark.
+		lua_remove(L, pool);
+	} else {
+		pop(L);
+
+		Class obj;
+		write(L, &obj);
+	}
+
+	Class* ret = nullptr;
+	read(L, ret, Index(-1));
+
+	return ret;
+}
+
+template<typename Class> static int ValuePool_release(lua_State* L) {
+	const int n = getTop(L);
+	const int pool = ValuePool_table<Class>(L);
+	lua_Integer count = (lua_Integer)len(L, pool);
+	for (int i = 1; i <= n && count < SCRIPTING_LUA_VALUE_POOL_MAX_SIZE; ++i) {
+		Class* obj = nullptr;
+		read(L, obj, Index(i));
+		if (!obj)
+			continue;
+
+		push(L, i);
+		const bool pooled = lua_rawget(L, pool) != LUA_TNIL;
+		pop(L);
+		if (pooled) // Already released.
+			continue;
+
+		push(L, i);
+		lua_rawseti(L, pool, ++count);
+		push(L, i);
+		lua_pushboolean(L, true);
+		lua_rawset(L, pool); // Mark.
+	}
+	pop(L);
+
+	return 0;
+}
+
 /**< Algorithms. */
 
 static int Noiser_ctor(lua_State* L) {
@@ -2813,48 +3313,465 @@ static void open_Bytes(lua_State* L) {
 	);
 }
 
-/**< Color. */
-
-static int Color_ctor(lua_State* L) {
+static int BytesView_ctor(lua_State* L) {
 	const int n = getTop(L);
-	Color obj;
-	switch (n) {
-	case 3: {
-			Byte r = 255, g = 255, b = 255;
-			read<>(L, r, g, b);
-
-			obj = Color(r, g, b);
-		}
-
-		break;
-	case 4: {
-			Byte r = 255, g = 255, b = 255, a = 255;
-			read<>(L, r, g, b, a);
+	Bytes::Ptr* bytes = nullptr;
+	Enum y = BytesView::BYTE;
+	int offset = 1;
+	int count = -1;
+	check<>(L, bytes);
+	read<2>(L, y);
+	if (n >= 3)
+		read<3>(L, offset);
+	if (n >= 4)
+		read<4>(L, count);
 
-			obj = Color(r, g, b, a);
-		}
+	if (!bytes)
+		return write(L, nullptr);
+	if (y > BytesView::DOUBLE) {
+		error(L, "Invalid element type.");
 
-		break;
+		return 0;
 	}
 
+	--offset; // 1-based.
+	BytesView obj;
+	obj.bytes = *bytes;
+	obj.type = (BytesView::Types)y;
+	obj.offset = (size_t)std::max(offset, 0);
+	if (count >= 0)
+		obj.limit = (size_t)count;
+
 	return write(L, &obj);
 }
 
-static int Color___tostring(lua_State* L) {
-	Color* obj = nullptr;
+static int BytesView___len(lua_State* L) {
+	BytesView* obj = nullptr;
 	check<>(L, obj);
 
-	std::string str;
+	if (obj) {
+		const size_t ret = obj->count();
 
-	str += "Color[0x";
-	str += Text::toHex(obj->toRGBA());
-	str += "]";
+		return write(L, ret);
+	}
 
-	return write(L, str);
+	return 0;
 }
 
-static int Color___add(lua_State* L) {
-	Color* obj = nullptr;
+static int BytesView_fill(lua_State* L) {
+	BytesView* obj = nullptr;
+	double val = 0;
+	check<>(L, obj);
+	read<2>(L, val);
+
+	if (!obj)
+		return 0;
+
+	const size_t n = obj->count();
+	Byte* ptr = obj->pointer();
+	obj->visit(
+		[&] (auto tag) -> void {
+			typedef decltype(tag) T;
+
+			for (size_t i = 0; i < n; ++i)
+				BytesView::store<T>(ptr, i, val);
+		}
+	);
+
+	return 0;
+}
+
+static int BytesView_axpy(lua_State* L) {
+	BytesView* obj = nullptr;
+	double a = 1;
+	BytesView* x = nullptr;
+	check<>(L, obj);
+	read<2>(L, a);
+	check<3>(L, x);
+
+	if (!obj || !x)
+		return 0;
+
+	const size_t n = std::min(obj->count(), x->count());
+	Byte* dst = obj->pointer();
+	const Byte* src = x->pointer();
+	obj->visit(
+		[&] (auto tagY) -> void {
+			typedef decltype(tagY) Y;
+
+			x->visit(
+				[&] (auto tagX) -> void {
+					typedef decltype(tagX) X;
+
+					for (size_t i = 0; i < n; ++i) {
+						const double val = a * (double)BytesView::load<X>(src, i) + (double)BytesView::load<Y>(dst, i);
+						BytesView::store<Y>(dst, i, val);
+					}
+				}
+			);
+		}
+	);
+
+	return 0;
+}
+
+static int BytesView_clamp(lua_State* L) {
+	BytesView* obj = nullptr;
+	double lo = 0, hi = 0;
+	check<>(L, obj);
+	read<2>(L, lo, hi);
+
+	if (!obj)
+		return 0;
+
+	const size_t n = obj->count();
+	Byte* ptr = obj->pointer();
+	obj->visit(
+		[&] (auto tag) -> void {
+			typedef decltype(tag) T;
+
+			for (size_t i = 0; i < n; ++i) {
+				const double val = (double)BytesView::load<T>(ptr, i);
+				if (val < lo)
+					BytesView::store<T>(ptr, i, lo);
+				else if (val > hi)
+					BytesView::store<T>(ptr, i, hi);
+			}
+		}
+	);
+
+	return 0;
+}
+
+static int BytesView_map(lua_State* L) {
+	BytesView* obj = nullptr;
+	BytesView* lut = nullptr;
+	check<>(L, obj, lut);
+
+	if (!obj || !lut)
+		return 0;
+
+	const size_t n = obj->count();
+	const size_t m = lut->count();
+	if (m == 0)
+		return 0;
+
+	Byte* dst = obj->pointer();
+	const Byte* src = lut->pointer();
+	obj->visit(
+		[&] (auto tagY) -> void {
+			typedef decltype(tagY) Y;
+
+			lut->visit(
+				[&] (auto tagL) -> void {
+					typedef decltype(tagL) U;
+
+					for (size_t i = 0; i < n; ++i) {
+						const double key = (double)BytesView::load<Y>(dst, i);
+						const size_t idx = key <= 0 ? 0 : std::min((size_t)key, m - 1); // 0-based.
+						BytesView::store<Y>(dst, i, (double)BytesView::load<U>(src, idx));
+					}
+				}
+			);
+		}
+	);
+
+	return 0;
+}
+
+static int BytesView_min(lua_State* L) {
+	BytesView* obj = nullptr;
+	check<>(L, obj);
+
+	if (!obj)
+		return 0;
+
+	const size_t n = obj->count();
+	if (n == 0)
+		return 0;
+
+	double ret = 0;
+	const Byte* ptr = obj->pointer();
+	obj->visit(
+		[&] (auto tag) -> void {
+			typedef decltype(tag) T;
+
+			T val = BytesView::load<T>(ptr, 0);
+			for (size_t i = 1; i < n; ++i)
+				val = std::min(val, BytesView::load<T>(ptr, i));
+			ret = (double)val;
+		}
+	);
+
+	return write(L, ret);
+}
+
+static int BytesView_max(lua_State* L) {
+	BytesView* obj = nullptr;
+	check<>(L, obj);
+
+	if (!obj)
+		return 0;
+
+	const size_t n = obj->count();
+	if (n == 0)
+		return 0;
+
+	double ret = 0;
+	const Byte* ptr = obj->pointer();
+	obj->visit(
+		[&] (auto tag) -> void {
+			typedef decltype(tag) T;
+
+			T val = BytesView::load<T>(ptr, 0);
+			for (size_t i = 1; i < n; ++i)
+				val = std::max(val, BytesView::load<T>(ptr, i));
+			ret = (double)val;
+		}
+	);
+
+	return write(L, ret);
+}
+
+static int BytesView_sum(lua_State* L) {
+	BytesView* obj = nullptr;
+	check<>(L, obj);
+
+	if (!obj)
+		return 0;
+
+	const size_t n = obj->count();
+	double ret = 0;
+	const Byte* ptr = obj->pointer();
+	obj->visit(
+		[&] (auto tag) -> void {
+			typedef decltype(tag) T;
+
+			for (size_t i = 0; i < n; ++i)
+				ret += (double)BytesView::load<T>(ptr, i);
+		}
+	);
+
+	return write(L, ret);
+}
+
+static int BytesView_normalize2(lua_State* L) {
+	const int n_ = getTop(L);
+	BytesView* obj = nullptr;
+	int stride = 2;
+	int first = 1;
+	check<>(L, obj);
+	if (n_ >= 2)
+		read<2>(L, stride);
+	if (n_ >= 3)
+		read<3>(L, first);
+
+	--first; // 1-based.
+	if (!obj || stride < 1 || first < 0)
+		return 0;
+
+	const size_t n = obj->count();
+	Byte* ptr = obj->pointer();
+	obj->visit(
+		[&] (auto tag) -> void {
+			typedef decltype(tag) T;
+
+			for (size_t i = (size_t)first; i + 1 < n; i += (size_t)stride) {
+				const double x = (double)BytesView::load<T>(ptr, i);
+				const double y = (double)BytesView::load<T>(ptr, i + 1);
+				const double len = std::sqrt(x * x + y * y);
+				if (len <= 0)
+					continue;
+
+				BytesView::store<T>(ptr, i, x / len);
+				BytesView::store<T>(ptr, i + 1, y / len);
+			}
+		}
+	);
+
+	return 0;
+}
+
+static int BytesView_rotate2(lua_State* L) {
+	const int n_ = getTop(L);
+	BytesView* obj = nullptr;
+	double angle = 0;
+	int stride = 2;
+	int first = 1;
+	check<>(L, obj);
+	read<2>(L, angle);
+	if (n_ >= 3)
+		read<3>(L, stride);
+	if (n_ >= 4)
+		read<4>(L, first);
+
+	--first; // 1-based.
+	if (!obj || stride < 1 || first < 0)
+		return 0;
+
+	const double s = std::sin(angle);
+	const double c = std::cos(angle);
+	const size_t n = obj->count();
+	Byte* ptr = obj->pointer();
+	obj->visit(
+		[&] (auto tag) -> void {
+			typedef decltype(tag) T;
+
+			for (size_t i = (size_t)first; i + 1 < n; i += (size_t)stride) {
+				const double x = (double)BytesView::load<T>(ptr, i);
+				const double y = (double)BytesView::load<T>(ptr, i + 1);
+				BytesView::store<T>(ptr, i, x * c - y * s);
+				BytesView::store<T>(ptr, i + 1, x * s + y * c);
+			}
+		}
+	);
+
+	return 0;
+}
+
+static int BytesView___index(lua_State* L) {
+	BytesView* obj = nullptr;
+	const char* field = nullptr;
+	check<>(L, obj);
+
+	if (!obj)
+		return 0;
+
+	if (isNumber(L, 2)) {
+		int index = 1;
+		read<2>(L, index);
+
+		--index; // 1-based.
+		if (index >= 0 && index < (int)obj->count()) {
+			const double ret = obj->get((size_t)index);
+
+			return write(L, ret);
+		}
+
+		return 0;
+	}
+
+	read<2>(L, field);
+	if (!field)
+		return 0;
+
+	if (strcmp(field, "bytes") == 0) {
+		return write(L, &obj->bytes);
+	} else if (strcmp(field, "type") == 0) {
+		return write(L, (Enum)obj->type);
+	} else if (strcmp(field, "offset") == 0) {
+		return write(L, obj->offset + 1); // 1-based.
+	} else {
+		return __index(L, field);
+	}
+}
+
+static int BytesView___newindex(lua_State* L) {
+	BytesView* obj = nullptr;
+	check<>(L, obj);
+
+	if (!obj)
+		return 0;
+
+	if (isNumber(L, 2)) {
+		int index = 1;
+		double val = 0;
+		read<2>(L, index, val);
+
+		--index; // 1-based.
+		if (index >= 0 && index < (int)obj->count())
+			obj->set((size_t)index, val);
+	}
+
+	return 0;
+}
+
+static void open_BytesView(lua_State* L) {
+	def(
+		L, "BytesView",
+		LUA_LIB(
+			array(
+				luaL_Reg{ "new", BytesView_ctor },
+				luaL_Reg{ nullptr, nullptr }
+			)
+		),
+		array(
+			luaL_Reg{ "__gc", __gc<BytesView> },
+			luaL_Reg{ "__tostring", __tostring<BytesView> },
+			luaL_Reg{ "__len", BytesView___len },
+			luaL_Reg{ nullptr, nullptr }
+		),
+		array(
+			luaL_Reg{ "fill", BytesView_fill },
+			luaL_Reg{ "axpy", BytesView_axpy },
+			luaL_Reg{ "clamp", BytesView_clamp },
+			luaL_Reg{ "map", BytesView_map },
+			luaL_Reg{ "min", BytesView_min },
+			luaL_Reg{ "max", BytesView_max },
+			luaL_Reg{ "sum", BytesView_sum },
+			luaL_Reg{ "normalize2", BytesView_normalize2 },
+			luaL_Reg{ "rotate2", BytesView_rotate2 },
+			luaL_Reg{ nullptr, nullptr }
+		),
+		BytesView___index, BytesView___newindex
+	);
+
+	getGlobal(L, "BytesView");
+	setTable(
+		L,
+		"Byte", (Enum)BytesView::BYTE,
+		"Int16", (Enum)BytesView::INT16,
+		"UInt16", (Enum)BytesView::UINT16,
+		"Int32", (Enum)BytesView::INT32,
+		"UInt32", (Enum)BytesView::UINT32,
+		"Single", (Enum)BytesView::SINGLE,
+		"Double", (Enum)BytesView::DOUBLE
+	);
+	pop(L);
+}
+
+/**< Color. */
+
+static int Color_ctor(lua_State* L) {
+	const int n = getTop(L);
+	Color obj;
+	switch (n) {
+	case 3: {
+			Byte r = 255, g = 255, b = 255;
+			read<>(L, r, g, b);
+
+			obj = Color(r, g, b);
+		}
+
+		break;
+	case 4: {
+			Byte r = 255, g = 255, b = 255, a = 255;
+			read<>(L, r, g, b, a);
+
+			obj = Color(r, g, b, a);
+		}
+
+		break;
+	}
+
+	return write(L, &obj);
+}
+
+static int Color___tostring(lua_State* L) {
+	Color* obj = nullptr;
+	check<>(L, obj);
+
+	std::string str;
+
+	str += "Color[0x";
+	str += Text::toHex(obj->toRGBA());
+	str += "]";
+
+	return write(L, str);
+}
+
+static int Color___add(lua_State* L) {
+	Color* obj = nullptr;
 	Color* other = nullptr;
 	check<>(L, obj, other);
 
@@ -2975,6 +3892,126 @@ static int Color_fromRGBA(lua_State* L) {
 	return 0;
 }
 
+static int Color_set(lua_State* L) {
+	const int n = getTop(L);
+	Color* obj = nullptr;
+	Color* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		if (n >= 4) {
+			Byte r = 255, g = 255, b = 255, a = 255;
+			read<2>(L, r, g, b);
+			if (n >= 5)
+				read<5>(L, a);
+
+			*obj = Color(r, g, b, a);
+		} else {
+			read<2>(L, other);
+			if (other)
+				*obj = *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Color_unpack(lua_State* L) {
+	Color* obj = nullptr;
+	read<>(L, obj);
+
+	if (obj)
+		return write(L, obj->r, obj->g, obj->b, obj->a);
+
+	return 0;
+}
+
+static int Color_addInPlace(lua_State* L) {
+	Color* obj = nullptr;
+	Color* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		check<2>(L, other);
+		if (other)
+			*obj = *obj + *other;
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Color_subInPlace(lua_State* L) {
+	Color* obj = nullptr;
+	Color* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		check<2>(L, other);
+		if (other)
+			*obj = *obj - *other;
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Color_mulInPlace(lua_State* L) {
+	Color* obj = nullptr;
+	Color* other = nullptr;
+	Math::Vec4f* vec = nullptr;
+	Real num = 0;
+	read<>(L, obj);
+
+	if (obj) {
+		if (isNumber(L, 2)) {
+			read<2>(L, num);
+
+			*obj = *obj * num;
+		} else {
+			read<2>(L, other);
+			read<2>(L, vec);
+			if (other) {
+				*obj = *obj * *other;
+			} else if (vec) {
+				*obj = Color(
+					(Byte)Math::clamp((float)(obj->r * vec->x), 0.0f, 255.0f),
+					(Byte)Math::clamp((float)(obj->g * vec->y), 0.0f, 255.0f),
+					(Byte)Math::clamp((float)(obj->b * vec->z), 0.0f, 255.0f),
+					(Byte)Math::clamp((float)(obj->a * vec->w), 0.0f, 255.0f)
+				);
+			} else {
+				error(L, "Number, Color or Vec4 expected.");
+
+				return 0;
+			}
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Color_acquire(lua_State* L) {
+	const int n = getTop(L);
+	Byte r = 255, g = 255, b = 255, a = 255;
+	if (n >= 3)
+		read<>(L, r, g, b);
+	if (n >= 4)
+		read<4>(L, a);
+
+	Color* obj = ValuePool_acquire<Color>(L);
+	if (obj)
+		*obj = Color(r, g, b, a);
+
+	return 1;
+}
+
 static int Color___index(lua_State* L) {
 	Color* obj = nullptr;
 	const char* field = nullptr;
@@ -3035,6 +4072,8 @@ static void open_Color(lua_State* L) {
 		LUA_LIB(
 			array(
 				luaL_Reg{ "new", Color_ctor },
+				luaL_Reg{ "acquire", Color_acquire },
+				luaL_Reg{ "release", ValuePool_release<Color> },
 				luaL_Reg{ nullptr, nullptr }
 			)
 		),
@@ -3051,6 +4090,11 @@ static void open_Color(lua_State* L) {
 		array(
 			luaL_Reg{ "toRGBA", Color_toRGBA },
 			luaL_Reg{ "fromRGBA", Color_fromRGBA },
+			luaL_Reg{ "set", Color_set },
+			luaL_Reg{ "unpack", Color_unpack },
+			luaL_Reg{ "addInPlace", Color_addInPlace },
+			luaL_Reg{ "subInPlace", Color_subInPlace },
+			luaL_Reg{ "mulInPlace", Color_mulInPlace },
 			luaL_Reg{ nullptr, nullptr }
 		),
 		Color___index, Color___newindex
@@ -4848,12 +5892,55 @@ static int Json_fromTable(lua_State* L) {
 	return 0;
 }
 
+static int Json_decode(lua_State* L) {
+	const int n = getTop(L);
+	bool allowNull = false;
+	if (n >= 2)
+		read<2>(L, allowNull);
+
+	std::string err;
+	if (isString(L, 1)) {
+		size_t len = 0;
+		const char* str = lua_tolstring(L, 1, &len);
+		if (decodeJson(L, str, len, allowNull, &err))
+			return 1;
+	} else {
+		Bytes::Ptr* bytes = nullptr;
+		read<>(L, bytes);
+		if (bytes && bytes->get()) {
+			Bytes* ptr = bytes->get();
+			if (ptr->empty())
+				return write(L, nullptr);
+			if (decodeJson(L, (const char*)ptr->pointer(), ptr->count(), allowNull, &err))
+				return 1;
+		}
+	}
+	if (!err.empty())
+		return write(L, nullptr, err);
+
+	return write(L, nullptr);
+}
+
+static int Json_encode(lua_State* L) {
+	const int n = getTop(L);
+	bool pretty = true;
+	if (n >= 2)
+		read<2>(L, pretty);
+
+	std::string ret;
+	encodeJson(L, Index(1), ret, pretty);
+
+	return write(L, ret);
+}
+
 static void open_Json(lua_State* L) {
 	def(
 		L, "Json",
 		LUA_LIB(
 			array(
 				luaL_Reg{ "new", Json_ctor },
+				luaL_Reg{ "decode", Json_decode },
+				luaL_Reg{ "encode", Json_encode },
 				luaL_Reg{ nullptr, nullptr }
 			)
 		),
@@ -5060,66 +6147,289 @@ static int Vec2_cross(lua_State* L) {
 		if (isNumber(L, 2)) {
 			read<2>(L, num);
 
-			const Math::Vec2f ret = obj->cross(num);
+			const Math::Vec2f ret = obj->cross(num);
+
+			return write(L, &ret);
+		} else {
+			read<2>(L, other);
+			if (!other)
+				return 0;
+
+			const Real ret = obj->cross(*other);
+
+			return write(L, ret);
+		}
+	}
+
+	return 0;
+}
+
+static int Vec2_angleTo(lua_State* L) {
+	Math::Vec2f* obj = nullptr;
+	Math::Vec2f* other = nullptr;
+	read<>(L, obj, other);
+
+	if (obj && other) {
+		const Real ret = obj->angleTo(*other);
+
+		return write(L, ret);
+	}
+
+	return 0;
+}
+
+static int Vec2_rotated(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec2f* obj = nullptr;
+	Math::Vec2f::ValueType angle = 0;
+	Math::Rotf* rot = nullptr;
+	Math::Vec2f* pivot = nullptr;
+	read<>(L, obj);
+	if (isNumber(L, 2)) {
+		read<2>(L, angle);
+	} else {
+		read<2>(L, rot);
+		angle = rot->angle();
+	}
+	if (n >= 3)
+		read<3>(L, pivot);
+
+	if (obj) {
+		if (pivot) {
+			const Math::Vec2f ret = obj->rotated(angle, *pivot);
+
+			return write(L, &ret);
+		} else {
+			const Math::Vec2f ret = obj->rotated(angle);
+
+			return write(L, &ret);
+		}
+	}
+
+	return 0;
+}
+
+static int Vec2_set(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec2f* obj = nullptr;
+	Math::Vec2f* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		if (n >= 3) {
+			Math::Vec2f::ValueType x = 0, y = 0;
+			read<2>(L, x, y);
+
+			obj->x = x;
+			obj->y = y;
+		} else {
+			read<2>(L, other);
+			if (other)
+				*obj = *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Vec2_unpack(lua_State* L) {
+	Math::Vec2f* obj = nullptr;
+	read<>(L, obj);
+
+	if (obj)
+		return write(L, obj->x, obj->y);
+
+	return 0;
+}
+
+static int Vec2_addInPlace(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec2f* obj = nullptr;
+	Math::Vec2f* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		if (n >= 3) {
+			Math::Vec2f::ValueType x = 0, y = 0;
+			read<2>(L, x, y);
+
+			*obj += Math::Vec2f(x, y);
+		} else {
+			check<2>(L, other);
+			if (other)
+				*obj += *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Vec2_subInPlace(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec2f* obj = nullptr;
+	Math::Vec2f* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		if (n >= 3) {
+			Math::Vec2f::ValueType x = 0, y = 0;
+			read<2>(L, x, y);
+
+			*obj -= Math::Vec2f(x, y);
+		} else {
+			check<2>(L, other);
+			if (other)
+				*obj -= *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Vec2_mulInPlace(lua_State* L) {
+	Math::Vec2f* obj = nullptr;
+	Math::Vec2f* other = nullptr;
+	Math::Vec2f::ValueType num = 0;
+	read<>(L, obj);
+
+	if (obj) {
+		if (isNumber(L, 2)) {
+			read<2>(L, num);
+
+			*obj *= num;
+		} else {
+			check<2>(L, other);
+			if (other)
+				*obj *= *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Vec2_rotateInPlace(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec2f* obj = nullptr;
+	Math::Vec2f::ValueType angle = 0;
+	Math::Rotf* rot = nullptr;
+	Math::Vec2f* pivot = nullptr;
+	read<>(L, obj);
+	if (isNumber(L, 2)) {
+		read<2>(L, angle);
+	} else {
+		check<2>(L, rot);
+		angle = rot->angle();
+	}
+	if (n >= 3)
+		read<3>(L, pivot);
+
+	if (obj) {
+		if (pivot)
+			*obj = obj->rotated(angle, *pivot);
+		else
+			*obj = obj->rotated(angle);
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Vec2_acquire(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec2f::ValueType x = 0, y = 0;
+	if (n >= 2)
+		read<>(L, x, y);
+
+	Math::Vec2f* obj = ValuePool_acquire<Math::Vec2f>(L);
+	if (obj)
+		*obj = Math::Vec2f(x, y);
+
+	return 1;
+}
+
+static int Vec2_add(lua_State* L) {
+	Math::Vec2f::ValueType x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+	check<>(L, x0, y0, x1, y1);
+
+	return write(L, x0 + x1, y0 + y1);
+}
+
+static int Vec2_sub(lua_State* L) {
+	Math::Vec2f::ValueType x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+	check<>(L, x0, y0, x1, y1);
+
+	return write(L, x0 - x1, y0 - y1);
+}
+
+static int Vec2_mul(lua_State* L) {
+	Math::Vec2f::ValueType x = 0, y = 0, num = 0;
+	check<>(L, x, y, num);
+
+	return write(L, x * num, y * num);
+}
+
+static int Vec2_lengthOf(lua_State* L) {
+	Math::Vec2f::ValueType x = 0, y = 0;
+	check<>(L, x, y);
+
+	const Real ret = Math::Vec2f(x, y).length();
 
-			return write(L, &ret);
-		} else {
-			read<2>(L, other);
-			if (!other)
-				return 0;
+	return write(L, ret);
+}
 
-			const Real ret = obj->cross(*other);
+static int Vec2_normalizedOf(lua_State* L) {
+	Math::Vec2f::ValueType x = 0, y = 0;
+	check<>(L, x, y);
 
-			return write(L, ret);
-		}
-	}
+	Math::Vec2f vec(x, y);
+	const Real len = vec.normalize();
 
-	return 0;
+	return write(L, vec.x, vec.y, len);
 }
 
-static int Vec2_angleTo(lua_State* L) {
-	Math::Vec2f* obj = nullptr;
-	Math::Vec2f* other = nullptr;
-	read<>(L, obj, other);
+static int Vec2_distance(lua_State* L) {
+	Math::Vec2f::ValueType x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+	check<>(L, x0, y0, x1, y1);
 
-	if (obj && other) {
-		const Real ret = obj->angleTo(*other);
+	const Real ret = Math::Vec2f(x0, y0).distanceTo(Math::Vec2f(x1, y1));
 
-		return write(L, ret);
-	}
+	return write(L, ret);
+}
 
-	return 0;
+static int Vec2_dotOf(lua_State* L) {
+	Math::Vec2f::ValueType x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+	check<>(L, x0, y0, x1, y1);
+
+	const Real ret = Math::Vec2f(x0, y0).dot(Math::Vec2f(x1, y1));
+
+	return write(L, ret);
 }
 
-static int Vec2_rotated(lua_State* L) {
+static int Vec2_rotatedOf(lua_State* L) {
 	const int n = getTop(L);
-	Math::Vec2f* obj = nullptr;
-	Math::Vec2f::ValueType angle = 0;
-	Math::Rotf* rot = nullptr;
-	Math::Vec2f* pivot = nullptr;
-	read<>(L, obj);
-	if (isNumber(L, 2)) {
-		read<2>(L, angle);
-	} else {
-		read<2>(L, rot);
-		angle = rot->angle();
-	}
-	if (n >= 3)
-		read<3>(L, pivot);
-
-	if (obj) {
-		if (pivot) {
-			const Math::Vec2f ret = obj->rotated(angle, *pivot);
+	Math::Vec2f::ValueType x = 0, y = 0, angle = 0;
+	check<>(L, x, y, angle);
 
-			return write(L, &ret);
-		} else {
-			const Math::Vec2f ret = obj->rotated(angle);
+	Math::Vec2f ret;
+	if (n >= 5) {
+		Math::Vec2f::ValueType px = 0, py = 0;
+		check<4>(L, px, py);
 
-			return write(L, &ret);
-		}
+		ret = Math::Vec2f(x, y).rotated(angle, Math::Vec2f(px, py));
+	} else {
+		ret = Math::Vec2f(x, y).rotated(angle);
 	}
 
-	return 0;
+	return write(L, ret.x, ret.y);
 }
 
 static int Vec2___index(lua_State* L) {
@@ -5180,6 +6490,16 @@ static void open_Vec2(lua_State* L) {
 		LUA_LIB(
 			array(
 				luaL_Reg{ "new", Vec2_ctor },
+				luaL_Reg{ "acquire", Vec2_acquire },
+				luaL_Reg{ "release", ValuePool_release<Math::Vec2f> },
+				luaL_Reg{ "add", Vec2_add },
+				luaL_Reg{ "sub", Vec2_sub },
+				luaL_Reg{ "mul", Vec2_mul },
+				luaL_Reg{ "lengthOf", Vec2_lengthOf },
+				luaL_Reg{ "normalizedOf", Vec2_normalizedOf },
+				luaL_Reg{ "distance", Vec2_distance },
+				luaL_Reg{ "dotOf", Vec2_dotOf },
+				luaL_Reg{ "rotatedOf", Vec2_rotatedOf },
 				luaL_Reg{ nullptr, nullptr }
 			)
 		),
@@ -5201,6 +6521,12 @@ static void open_Vec2(lua_State* L) {
 			luaL_Reg{ "cross", Vec2_cross },
 			luaL_Reg{ "angleTo", Vec2_angleTo },
 			luaL_Reg{ "rotated", Vec2_rotated },
+			luaL_Reg{ "set", Vec2_set },
+			luaL_Reg{ "unpack", Vec2_unpack },
+			luaL_Reg{ "addInPlace", Vec2_addInPlace },
+			luaL_Reg{ "subInPlace", Vec2_subInPlace },
+			luaL_Reg{ "mulInPlace", Vec2_mulInPlace },
+			luaL_Reg{ "rotateInPlace", Vec2_rotateInPlace },
 			luaL_Reg{ nullptr, nullptr }
 		),
 		Vec2___index, Vec2___newindex
@@ -5380,6 +6706,175 @@ static int Vec3_dot(lua_State* L) {
 	return 0;
 }
 
+static int Vec3_set(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec3f* obj = nullptr;
+	Math::Vec3f* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		if (n >= 4) {
+			Math::Vec3f::ValueType x = 0, y = 0, z = 0;
+			read<2>(L, x, y, z);
+
+			obj->x = x;
+			obj->y = y;
+			obj->z = z;
+		} else {
+			read<2>(L, other);
+			if (other)
+				*obj = *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Vec3_unpack(lua_State* L) {
+	Math::Vec3f* obj = nullptr;
+	read<>(L, obj);
+
+	if (obj)
+		return write(L, obj->x, obj->y, obj->z);
+
+	return 0;
+}
+
+static int Vec3_addInPlace(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec3f* obj = nullptr;
+	Math::Vec3f* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		if (n >= 4) {
+			Math::Vec3f::ValueType x = 0, y = 0, z = 0;
+			read<2>(L, x, y, z);
+
+			*obj += Math::Vec3f(x, y, z);
+		} else {
+			check<2>(L, other);
+			if (other)
+				*obj += *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Vec3_subInPlace(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec3f* obj = nullptr;
+	Math::Vec3f* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		if (n >= 4) {
+			Math::Vec3f::ValueType x = 0, y = 0, z = 0;
+			read<2>(L, x, y, z);
+
+			*obj -= Math::Vec3f(x, y, z);
+		} else {
+			check<2>(L, other);
+			if (other)
+				*obj -= *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Vec3_mulInPlace(lua_State* L) {
+	Math::Vec3f* obj = nullptr;
+	Math::Vec3f* other = nullptr;
+	Math::Vec3f::ValueType num = 0;
+	read<>(L, obj);
+
+	if (obj) {
+		if (isNumber(L, 2)) {
+			read<2>(L, num);
+
+			*obj *= num;
+		} else {
+			check<2>(L, other);
+			if (other)
+				*obj *= *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Vec3_acquire(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec3f::ValueType x = 0, y = 0, z = 0;
+	if (n >= 3)
+		read<>(L, x, y, z);
+
+	Math::Vec3f* obj = ValuePool_acquire<Math::Vec3f>(L);
+	if (obj)
+		*obj = Math::Vec3f(x, y, z);
+
+	return 1;
+}
+
+static int Vec3_add(lua_State* L) {
+	Math::Vec3f::ValueType x0 = 0, y0 = 0, z0 = 0, x1 = 0, y1 = 0, z1 = 0;
+	check<>(L, x0, y0, z0, x1, y1, z1);
+
+	return write(L, x0 + x1, y0 + y1, z0 + z1);
+}
+
+static int Vec3_sub(lua_State* L) {
+	Math::Vec3f::ValueType x0 = 0, y0 = 0, z0 = 0, x1 = 0, y1 = 0, z1 = 0;
+	check<>(L, x0, y0, z0, x1, y1, z1);
+
+	return write(L, x0 - x1, y0 - y1, z0 - z1);
+}
+
+static int Vec3_mul(lua_State* L) {
+	Math::Vec3f::ValueType x = 0, y = 0, z = 0, num = 0;
+	check<>(L, x, y, z, num);
+
+	return write(L, x * num, y * num, z * num);
+}
+
+static int Vec3_lengthOf(lua_State* L) {
+	Math::Vec3f::ValueType x = 0, y = 0, z = 0;
+	check<>(L, x, y, z);
+
+	const Real ret = Math::Vec3f(x, y, z).length();
+
+	return write(L, ret);
+}
+
+static int Vec3_normalizedOf(lua_State* L) {
+	Math::Vec3f::ValueType x = 0, y = 0, z = 0;
+	check<>(L, x, y, z);
+
+	Math::Vec3f vec(x, y, z);
+	const Real len = vec.normalize();
+
+	return write(L, vec.x, vec.y, vec.z, len);
+}
+
+static int Vec3_dotOf(lua_State* L) {
+	Math::Vec3f::ValueType x0 = 0, y0 = 0, z0 = 0, x1 = 0, y1 = 0, z1 = 0;
+	check<>(L, x0, y0, z0, x1, y1, z1);
+
+	const Real ret = Math::Vec3f(x0, y0, z0).dot(Math::Vec3f(x1, y1, z1));
+
+	return write(L, ret);
+}
+
 static int Vec3___index(lua_State* L) {
 	Math::Vec3f* obj = nullptr;
 	const char* field = nullptr;
@@ -5441,6 +6936,14 @@ static void open_Vec3(lua_State* L) {
 		LUA_LIB(
 			array(
 				luaL_Reg{ "new", Vec3_ctor },
+				luaL_Reg{ "acquire", Vec3_acquire },
+				luaL_Reg{ "release", ValuePool_release<Math::Vec3f> },
+				luaL_Reg{ "add", Vec3_add },
+				luaL_Reg{ "sub", Vec3_sub },
+				luaL_Reg{ "mul", Vec3_mul },
+				luaL_Reg{ "lengthOf", Vec3_lengthOf },
+				luaL_Reg{ "normalizedOf", Vec3_normalizedOf },
+				luaL_Reg{ "dotOf", Vec3_dotOf },
 				luaL_Reg{ nullptr, nullptr }
 			)
 		),
@@ -5458,6 +6961,11 @@ static void open_Vec3(lua_State* L) {
 		array(
 			luaL_Reg{ "normalize", Vec3_normalize },
 			luaL_Reg{ "dot", Vec3_dot },
+			luaL_Reg{ "set", Vec3_set },
+			luaL_Reg{ "unpack", Vec3_unpack },
+			luaL_Reg{ "addInPlace", Vec3_addInPlace },
+			luaL_Reg{ "subInPlace", Vec3_subInPlace },
+			luaL_Reg{ "mulInPlace", Vec3_mulInPlace },
 			luaL_Reg{ nullptr, nullptr }
 		),
 		Vec3___index, Vec3___newindex
@@ -5509,86 +7017,207 @@ static int Vec4___tostring(lua_State* L) {
 	return write(L, str);
 }
 
-static int Vec4___add(lua_State* L) {
+static int Vec4___add(lua_State* L) {
+	Math::Vec4f* obj = nullptr;
+	Math::Vec4f* other = nullptr;
+	check<>(L, obj, other);
+
+	if (obj && other) {
+		const Math::Vec4f ret = *obj + *other;
+
+		return write(L, &ret);
+	}
+
+	return 0;
+}
+
+static int Vec4___sub(lua_State* L) {
+	Math::Vec4f* obj = nullptr;
+	Math::Vec4f* other = nullptr;
+	check<>(L, obj, other);
+
+	if (obj && other) {
+		const Math::Vec4f ret = *obj - *other;
+
+		return write(L, &ret);
+	}
+
+	return 0;
+}
+
+static int Vec4___mul(lua_State* L) {
+	Math::Vec4f* obj = nullptr;
+	Math::Vec4f* other = nullptr;
+	Math::Vec4f::ValueType num = 0;
+	check<>(L, obj);
+
+	if (obj) {
+		if (isNumber(L, 2)) {
+			check<2>(L, num);
+
+			const Math::Vec4f ret = *obj * num;
+
+			return write(L, &ret);
+		} else {
+			check<2>(L, other);
+			if (!other)
+				return 0;
+
+			const Math::Vec4f ret = *obj * *other;
+
+			return write(L, &ret);
+		}
+	}
+
+	return 0;
+}
+
+static int Vec4___unm(lua_State* L) {
+	Math::Vec4f* obj = nullptr;
+	check<>(L, obj);
+
+	if (obj) {
+		const Math::Vec4f ret = -*obj;
+
+		return write(L, &ret);
+	}
+
+	return 0;
+}
+
+static int Vec4___eq(lua_State* L) {
+	Math::Vec4f* obj = nullptr;
+	Math::Vec4f* other = nullptr;
+	check<>(L, obj, other);
+
+	if (obj && other) {
+		const bool ret = *obj == *other;
+
+		return write(L, ret);
+	}
+
+	return write(L, false);
+}
+
+static int Vec4_set(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec4f* obj = nullptr;
+	Math::Vec4f* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		if (n >= 5) {
+			Math::Vec4f::ValueType x = 0, y = 0, z = 0, w = 0;
+			read<2>(L, x, y, z, w);
+
+			obj->x = x;
+			obj->y = y;
+			obj->z = z;
+			obj->w = w;
+		} else {
+			read<2>(L, other);
+			if (other)
+				*obj = *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Vec4_unpack(lua_State* L) {
 	Math::Vec4f* obj = nullptr;
-	Math::Vec4f* other = nullptr;
-	check<>(L, obj, other);
-
-	if (obj && other) {
-		const Math::Vec4f ret = *obj + *other;
+	read<>(L, obj);
 
-		return write(L, &ret);
-	}
+	if (obj)
+		return write(L, obj->x, obj->y, obj->z, obj->w);
 
 	return 0;
 }
 
-static int Vec4___sub(lua_State* L) {
+static int Vec4_addInPlace(lua_State* L) {
+	const int n = getTop(L);
 	Math::Vec4f* obj = nullptr;
 	Math::Vec4f* other = nullptr;
-	check<>(L, obj, other);
+	read<>(L, obj);
 
-	if (obj && other) {
-		const Math::Vec4f ret = *obj - *other;
+	if (obj) {
+		if (n >= 5) {
+			Math::Vec4f::ValueType x = 0, y = 0, z = 0, w = 0;
+			read<2>(L, x, y, z, w);
 
-		return write(L, &ret);
+			*obj += Math::Vec4f(x, y, z, w);
+		} else {
+			check<2>(L, other);
+			if (other)
+				*obj += *other;
+		}
 	}
 
-	return 0;
+	push(L, 1);
+
+	return 1;
 }
 
-static int Vec4___mul(lua_State* L) {
+static int Vec4_subInPlace(lua_State* L) {
+	const int n = getTop(L);
 	Math::Vec4f* obj = nullptr;
 	Math::Vec4f* other = nullptr;
-	Math::Vec4f::ValueType num = 0;
-	check<>(L, obj);
+	read<>(L, obj);
 
 	if (obj) {
-		if (isNumber(L, 2)) {
-			check<2>(L, num);
+		if (n >= 5) {
+			Math::Vec4f::ValueType x = 0, y = 0, z = 0, w = 0;
+			read<2>(L, x, y, z, w);
 
-			const Math::Vec4f ret = *obj * num;
-
-			return write(L, &ret);
+			*obj -= Math::Vec4f(x, y, z, w);
 		} else {
 			check<2>(L, other);
-			if (!other)
-				return 0;
-
-			const Math::Vec4f ret = *obj * *other;
-
-			return write(L, &ret);
+			if (other)
+				*obj -= *other;
 		}
 	}
 
-	return 0;
+	push(L, 1);
+
+	return 1;
 }
 
-static int Vec4___unm(lua_State* L) {
+static int Vec4_mulInPlace(lua_State* L) {
 	Math::Vec4f* obj = nullptr;
-	check<>(L, obj);
+	Math::Vec4f* other = nullptr;
+	Math::Vec4f::ValueType num = 0;
+	read<>(L, obj);
 
 	if (obj) {
-		const Math::Vec4f ret = -*obj;
+		if (isNumber(L, 2)) {
+			read<2>(L, num);
 
-		return write(L, &ret);
+			*obj *= num;
+		} else {
+			check<2>(L, other);
+			if (other)
+				*obj *= *other;
+		}
 	}
 
-	return 0;
-}
+	push(L, 1);
 
-static int Vec4___eq(lua_State* L) {
-	Math::Vec4f* obj = nullptr;
-	Math::Vec4f* other = nullptr;
-	check<>(L, obj, other);
+	return 1;
+}
 
-	if (obj && other) {
-		const bool ret = *obj == *other;
+static int Vec4_acquire(lua_State* L) {
+	const int n = getTop(L);
+	Math::Vec4f::ValueType x = 0, y = 0, z = 0, w = 0;
+	if (n >= 4)
+		read<>(L, x, y, z, w);
 
-		return write(L, ret);
-	}
+	Math::Vec4f* obj = ValuePool_acquire<Math::Vec4f>(L);
+	if (obj)
+		*obj = Math::Vec4f(x, y, z, w);
 
-	return write(L, false);
+	return 1;
 }
 
 static int Vec4___index(lua_State* L) {
@@ -5651,6 +7280,8 @@ static void open_Vec4(lua_State* L) {
 		LUA_LIB(
 			array(
 				luaL_Reg{ "new", Vec4_ctor },
+				luaL_Reg{ "acquire", Vec4_acquire },
+				luaL_Reg{ "release", ValuePool_release<Math::Vec4f> },
 				luaL_Reg{ nullptr, nullptr }
 			)
 		),
@@ -5665,6 +7296,11 @@ static void open_Vec4(lua_State* L) {
 			luaL_Reg{ nullptr, nullptr }
 		),
 		array(
+			luaL_Reg{ "set", Vec4_set },
+			luaL_Reg{ "unpack", Vec4_unpack },
+			luaL_Reg{ "addInPlace", Vec4_addInPlace },
+			luaL_Reg{ "subInPlace", Vec4_subInPlace },
+			luaL_Reg{ "mulInPlace", Vec4_mulInPlace },
 			luaL_Reg{ nullptr, nullptr }
 		),
 		Vec4___index, Vec4___newindex
@@ -5821,6 +7457,57 @@ static int Rect_height(lua_State* L) {
 	return 0;
 }
 
+static int Rect_set(lua_State* L) {
+	const int n = getTop(L);
+	Math::Rectf* obj = nullptr;
+	Math::Rectf* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		if (n >= 5) {
+			Math::Rectf::ValueType x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+			read<2>(L, x0, y0, x1, y1);
+
+			*obj = Math::Rectf(x0, y0, x1, y1);
+		} else {
+			read<2>(L, other);
+			if (other)
+				*obj = *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Rect_unpack(lua_State* L) {
+	Math::Rectf* obj = nullptr;
+	read<>(L, obj);
+
+	if (obj)
+		return write(L, obj->x0, obj->y0, obj->x1, obj->y1);
+
+	return 0;
+}
+
+static int Rect_acquire(lua_State* L) {
+	const int n = getTop(L);
+	Math::Rectf val;
+	if (n >= 4) {
+		Math::Rectf::ValueType x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+		read<>(L, x0, y0, x1, y1);
+
+		val = Math::Rectf(x0, y0, x1, y1);
+	}
+
+	Math::Rectf* obj = ValuePool_acquire<Math::Rectf>(L);
+	if (obj)
+		*obj = val;
+
+	return 1;
+}
+
 static int Rect___index(lua_State* L) {
 	Math::Rectf* obj = nullptr;
 	const char* field = nullptr;
@@ -5881,6 +7568,8 @@ static void open_Rect(lua_State* L) {
 		LUA_LIB(
 			array(
 				luaL_Reg{ "new", Rect_ctor },
+				luaL_Reg{ "acquire", Rect_acquire },
+				luaL_Reg{ "release", ValuePool_release<Math::Rectf> },
 				luaL_Reg{ "byXYWH", Rect_byXYWH },
 				luaL_Reg{ nullptr, nullptr }
 			)
@@ -5898,6 +7587,8 @@ static void open_Rect(lua_State* L) {
 			luaL_Reg{ "yMax", Rect_yMax },
 			luaL_Reg{ "width", Rect_width },
 			luaL_Reg{ "height", Rect_height },
+			luaL_Reg{ "set", Rect_set },
+			luaL_Reg{ "unpack", Rect_unpack },
 			luaL_Reg{ nullptr, nullptr }
 		),
 		Rect___index, Rect___newindex
@@ -6041,6 +7732,57 @@ static int Recti_height(lua_State* L) {
 	return 0;
 }
 
+static int Recti_set(lua_State* L) {
+	const int n = getTop(L);
+	Math::Recti* obj = nullptr;
+	Math::Recti* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		if (n >= 5) {
+			Math::Recti::ValueType x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+			read<2>(L, x0, y0, x1, y1);
+
+			*obj = Math::Recti(x0, y0, x1, y1);
+		} else {
+			read<2>(L, other);
+			if (other)
+				*obj = *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Recti_unpack(lua_State* L) {
+	Math::Recti* obj = nullptr;
+	read<>(L, obj);
+
+	if (obj)
+		return write(L, obj->x0, obj->y0, obj->x1, obj->y1);
+
+	return 0;
+}
+
+static int Recti_acquire(lua_State* L) {
+	const int n = getTop(L);
+	Math::Recti val;
+	if (n >= 4) {
+		Math::Recti::ValueType x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+		read<>(L, x0, y0, x1, y1);
+
+		val = Math::Recti(x0, y0, x1, y1);
+	}
+
+	Math::Recti* obj = ValuePool_acquire<Math::Recti>(L);
+	if (obj)
+		*obj = val;
+
+	return 1;
+}
+
 static int Recti___index(lua_State* L) {
 	Math::Recti* obj = nullptr;
 	const char* field = nullptr;
@@ -6101,6 +7843,8 @@ static void open_Recti(lua_State* L) {
 		LUA_LIB(
 			array(
 				luaL_Reg{ "new", Recti_ctor },
+				luaL_Reg{ "acquire", Recti_acquire },
+				luaL_Reg{ "release", ValuePool_release<Math::Recti> },
 				luaL_Reg{ "byXYWH", Recti_byXYWH },
 				luaL_Reg{ nullptr, nullptr }
 			)
@@ -6118,6 +7862,8 @@ static void open_Recti(lua_State* L) {
 			luaL_Reg{ "yMax", Recti_yMax },
 			luaL_Reg{ "width", Recti_width },
 			luaL_Reg{ "height", Recti_height },
+			luaL_Reg{ "set", Recti_set },
+			luaL_Reg{ "unpack", Recti_unpack },
 			luaL_Reg{ nullptr, nullptr }
 		),
 		Recti___index, Recti___newindex
@@ -6233,6 +7979,105 @@ static int Rot___eq(lua_State* L) {
 	return write(L, false);
 }
 
+static int Rot_set(lua_State* L) {
+	const int n = getTop(L);
+	Math::Rotf* obj = nullptr;
+	Math::Rotf* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		if (n >= 3) {
+			Math::Rotf::ValueType s = 0, c = 0;
+			read<2>(L, s, c);
+
+			*obj = Math::Rotf(s, c);
+		} else {
+			read<2>(L, other);
+			if (other)
+				*obj = *other;
+		}
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Rot_unpack(lua_State* L) {
+	Math::Rotf* obj = nullptr;
+	read<>(L, obj);
+
+	if (obj)
+		return write(L, obj->s, obj->c);
+
+	return 0;
+}
+
+static int Rot_addInPlace(lua_State* L) {
+	Math::Rotf* obj = nullptr;
+	Math::Rotf* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		check<2>(L, other);
+		if (other)
+			*obj = Math::Rotf(obj->angle() + other->angle());
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Rot_subInPlace(lua_State* L) {
+	Math::Rotf* obj = nullptr;
+	Math::Rotf* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		check<2>(L, other);
+		if (other)
+			*obj = Math::Rotf(obj->angle() - other->angle());
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Rot_mulInPlace(lua_State* L) {
+	Math::Rotf* obj = nullptr;
+	Math::Rotf* other = nullptr;
+	read<>(L, obj);
+
+	if (obj) {
+		check<2>(L, other);
+		if (other)
+			*obj = *obj * *other;
+	}
+
+	push(L, 1);
+
+	return 1;
+}
+
+static int Rot_acquire(lua_State* L) {
+	const int n = getTop(L);
+	Math::Rotf val;
+	if (n >= 2) {
+		Math::Rotf::ValueType s = 0, c = 0;
+		read<>(L, s, c);
+
+		val = Math::Rotf(s, c);
+	}
+
+	Math::Rotf* obj = ValuePool_acquire<Math::Rotf>(L);
+	if (obj)
+		*obj = val;
+
+	return 1;
+}
+
 static int Rot___index(lua_State* L) {
 	Math::Rotf* obj = nullptr;
 	const char* field = nullptr;
@@ -6288,6 +8133,8 @@ static void open_Rot(lua_State* L) {
 		LUA_LIB(
 			array(
 				luaL_Reg{ "new", Rot_ctor },
+				luaL_Reg{ "acquire", Rot_acquire },
+				luaL_Reg{ "release", ValuePool_release<Math::Rotf> },
 				luaL_Reg{ nullptr, nullptr }
 			)
 		),
@@ -6302,6 +8149,11 @@ static void open_Rot(lua_State* L) {
 			luaL_Reg{ nullptr, nullptr }
 		),
 		array(
+			luaL_Reg{ "set", Rot_set },
+			luaL_Reg{ "unpack", Rot_unpack },
+			luaL_Reg{ "addInPlace", Rot_addInPlace },
+			luaL_Reg{ "subInPlace", Rot_subInPlace },
+			luaL_Reg{ "mulInPlace", Rot_mulInPlace },
 			luaL_Reg{ nullptr, nullptr }
 		),
 		Rot___index, Rot___newindex
@@ -6500,18 +8352,18 @@ static void Network_setOnReceived(lua_State* L, Network::Ptr &obj, const Functio
 			Network::DataTypes y = obj->dataType();
 			switch (y) {
 			case Network::STREAM: {
-					Bytes* bytes = (Bytes*)data;
+					const Byte* bytes = (const Byte*)data; // A view, copied to keep.
 					Bytes::Ptr val(Bytes::create());
-					val->writeBytes(bytes);
+					val->writeBytes(bytes, size);
 					val->poke(0);
 					ScriptingLua::check(L, call(L, **ptr, &val, size, addr));
 				}
 
 				break;
 			case Network::BYTES: {
-					Bytes* bytes = (Bytes*)data;
+					const Byte* bytes = (const Byte*)data; // A view, copied to keep.
 					Bytes::Ptr val(Bytes::create());
-					val->writeBytes(bytes);
+					val->writeBytes(bytes, size);
 					val->poke(0);
 					ScriptingLua::check(L, call(L, **ptr, &val, size, addr));
 				}
@@ -6955,7 +8807,8 @@ static void open_Network(lua_State* L) {
 		L,
 		"None", (Enum)Network::NONE,
 		"Udp", (Enum)Network::UDP,
-		"Tcp", (Enum)Network::TCP
+		"Tcp", (Enum)Network::TCP,
+		"WebSocket", (Enum)Network::WEBSOCKET
 	);
 	pop(L);
 }
@@ -7384,6 +9237,7 @@ void open(class Executable* exec) {
 
 	// Bytes.
 	open_Bytes(L);
+	open_BytesView(L);
 
 	// Color.
 	open_Color(L);
@@ -7431,6 +9285,44 @@ void open(class Executable* exec) {
 	open_Web(L);
 }
 
+void worker(lua_State* L) {
+	// Light userdata.
+	open_LightUserdata(L);
+
+	// Algorithms.
+	open_Noiser(L);
+	open_Pathfinder(L);
+	open_Random(L);
+	open_Raycaster(L);
+	open_Walker(L);
+
+	// Bytes.
+	open_Bytes(L);
+	open_BytesView(L);
+
+	// Color.
+	open_Color(L);
+
+	// Encoding.
+	open_Base64(L);
+	open_Lz4(L);
+
+	// Date time.
+	open_DateTime(L);
+
+	// JSON.
+	open_Json(L);
+
+	// Math.
+	open_Vec2(L);
+	open_Vec3(L);
+	open_Vec4(L);
+	open_Rect(L);
+	open_Recti(L);
+	open_Rot(L);
+	open_Math(L);
+}
+
 }
 
 }
@@ -9866,6 +11758,17 @@ static int Application_setOption(lua_State* L) {
 			nullptr,
 			true
 		);
+	} else if (key == "fixed_step") {
+		double step = 0;
+		if (!isNil(L, 2))
+			read<2>(L, step);
+		if (step < 0) {
+			error(L, "Invalid step.");
+
+			return 0;
+		}
+
+		impl->fixedStep(step);
 	} else {
 		error(L, "Invalid option.");
 	}
@@ -10633,6 +12536,8 @@ static int Project_save(lua_State* L) {
 		Path::touchDirectory(path.c_str());
 	else if (Text::endsWith(path, "." BITTY_ZIP_EXT, true))
 		prj->preference(Archive::ZIP);
+	else if (Text::endsWith(path, "." BITTY_PACK_EXT, true))
+		prj->preference(Archive::BIN);
 	else
 		prj->preference(Archive::TXT);
 	if (!prj->save(path.c_str(), true, [] (const char*) -> void { /* Do nothing. */ }))
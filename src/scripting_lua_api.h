@@ -143,6 +143,7 @@ namespace Lua {
 namespace Standard {
 
 void open(class Executable* exec);
+void worker(lua_State* L);
 
 }
 
@@ -160,6 +161,7 @@ namespace Lua {
 namespace Libs {
 
 void open(class Executable* exec);
+void worker(lua_State* L);
 
 }
 
@@ -8,6 +8,8 @@
 ** For the latest info, see https://github.com/paladin-t/bitty/
 */
 
+#include "bytes.h"
+#include "datetime.h"
 #include "scripting_lua.h"
 #include "scripting_lua_api_physics.h"
 #include "../lib/chipmunk2d/include/chipmunk/chipmunk.h"
@@ -15,16 +17,50 @@
 extern "C" {
 #endif
 #	include "../lib/chipmunk2d/include/chipmunk/chipmunk_structs.h"
+#	include "../lib/chipmunk2d/include/chipmunk/cpHastySpace.h"
 #ifdef __cplusplus
 }
 #endif
 #include <map>
+#include <thread>
+#include <unordered_map>
 
 /*
 ** {===========================================================================
 ** Macros and constants
 */
 
+// Indicates whether the threaded solver of Chipmunk is available, it depends
+// on pthread or its Win32 counterpart in the library which doesn't compile as
+// C with VC++.
+#ifndef SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED
+#	if defined BITTY_CP_VC || defined BITTY_OS_HTML
+#		define SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED 0
+#	else /* Platform macro. */
+#		define SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED 1
+#	endif /* Platform macro. */
+#endif /* SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED */
+
+#ifndef SCRIPTING_LUA_PHYSICS_ADVANCE_MAX_STEP_COUNT
+#	define SCRIPTING_LUA_PHYSICS_ADVANCE_MAX_STEP_COUNT 5
+#endif /* SCRIPTING_LUA_PHYSICS_ADVANCE_MAX_STEP_COUNT */
+
+#ifndef SCRIPTING_LUA_PHYSICS_COLLISION_EVENT_MAX_COUNT
+#	define SCRIPTING_LUA_PHYSICS_COLLISION_EVENT_MAX_COUNT 65536
+#endif /* SCRIPTING_LUA_PHYSICS_COLLISION_EVENT_MAX_COUNT */
+
+#ifndef SCRIPTING_LUA_PHYSICS_STATISTICS_INTERVAL_NANOSECONDS
+#	define SCRIPTING_LUA_PHYSICS_STATISTICS_INTERVAL_NANOSECONDS 500000000ll
+#endif /* SCRIPTING_LUA_PHYSICS_STATISTICS_INTERVAL_NANOSECONDS */
+
+#ifndef SCRIPTING_LUA_PHYSICS_TUNE_INTERVAL_STEP_COUNT
+#	define SCRIPTING_LUA_PHYSICS_TUNE_INTERVAL_STEP_COUNT 120
+#endif /* SCRIPTING_LUA_PHYSICS_TUNE_INTERVAL_STEP_COUNT */
+
+#ifndef SCRIPTING_LUA_PHYSICS_TUNE_MIN_SHAPE_COUNT
+#	define SCRIPTING_LUA_PHYSICS_TUNE_MIN_SHAPE_COUNT 256
+#endif /* SCRIPTING_LUA_PHYSICS_TUNE_MIN_SHAPE_COUNT */
+
 #ifndef LUA_WEAK_PTR
 #	define LUA_WEAK_PTR(TYPE, PTR, DTOR, WEAK, SHARED) \
 		const TYPE::Ptr SHARED( \
@@ -60,6 +96,13 @@ LUA_CHECK_ALIAS(Math::Rotf, Rot)
 LUA_WRITE_ALIAS(Math::Rotf, Rot)
 LUA_WRITE_ALIAS_CONST(Math::Rotf, Rot)
 
+/**< Bytes. */
+
+LUA_CHECK_OBJ(Bytes)
+LUA_READ_OBJ(Bytes)
+LUA_WRITE_OBJ(Bytes)
+LUA_WRITE_OBJ_CONST(Bytes)
+
 }
 
 namespace Lua { // Engine.
@@ -323,6 +366,76 @@ LUA_READ_ALIAS(Space::Ptr, Space)
 LUA_WRITE_ALIAS(Space::Ptr, Space)
 LUA_WRITE_ALIAS_CONST(Space::Ptr, Space)
 
+/**< Packed. */
+
+/**
+ * @brief Helpers to access records of double precision real numbers in
+ *   `Bytes`, which might be unaligned.
+ */
+struct Packed {
+	static size_t count(const Bytes* bytes, size_t stride) {
+		return bytes->count() / (stride * sizeof(Double));
+	}
+	static Double read(const Byte* &cursor) {
+		Double ret = 0;
+		memcpy(&ret, cursor, sizeof(Double));
+		cursor += sizeof(Double);
+
+		return ret;
+	}
+	static void write(Byte* &cursor, Double val) {
+		memcpy(cursor, &val, sizeof(Double));
+		cursor += sizeof(Double);
+	}
+};
+
+/**< Body state. */
+
+struct BodyState {
+	enum Fields : Enum {
+		ID,
+		X,
+		Y,
+		ANGLE,
+		VX,
+		VY,
+		SLEEPING,
+		INTERPOLATED_X,
+		INTERPOLATED_Y,
+		INTERPOLATED_ANGLE,
+
+		COUNT
+	};
+	typedef std::vector<Fields> Array;
+
+	static bool parse(const char* name, Fields &ret) {
+		if (strcmp(name, "id") == 0)
+			ret = ID;
+		else if (strcmp(name, "x") == 0)
+			ret = X;
+		else if (strcmp(name, "y") == 0)
+			ret = Y;
+		else if (strcmp(name, "angle") == 0)
+			ret = ANGLE;
+		else if (strcmp(name, "vx") == 0)
+			ret = VX;
+		else if (strcmp(name, "vy") == 0)
+			ret = VY;
+		else if (strcmp(name, "sleeping") == 0)
+			ret = SLEEPING;
+		else if (strcmp(name, "ix") == 0)
+			ret = INTERPOLATED_X;
+		else if (strcmp(name, "iy") == 0)
+			ret = INTERPOLATED_Y;
+		else if (strcmp(name, "iangle") == 0)
+			ret = INTERPOLATED_ANGLE;
+		else
+			return false;
+
+		return true;
+	}
+};
+
 }
 
 namespace Lua { // Generic.
@@ -697,6 +810,9 @@ struct BodyData : public ReferencableData<Body::Ptr, Body::WeakPtr>, public Mana
 	lua_State* L = nullptr;
 	Function::Ptr velocityHandler = nullptr;
 	Function::Ptr positionHandler = nullptr;
+	cpVect previousPosition = cpVect{ 0, 0 };
+	cpFloat previousAngle = 0;
+	unsigned snapshot = 0; // Matches `SpaceData::snapshot` if the previous transform is valid.
 
 	BodyData(Body::Ptr &self_, lua_State* L_) : ReferencableData(self_), L(L_) {
 	}
@@ -792,8 +908,40 @@ struct SpaceData : public ReferencableData<Space::Ptr, Space::WeakPtr> {
 		}
 	};
 	typedef std::map<CollisionKey, CollisionHandler> CollisionHandlerDictionary;
+	enum CollisionEvents : unsigned {
+		COLLISION_BEGAN = 1 << 0,
+		COLLISION_POST_SOLVED = 1 << 1,
+		COLLISION_SEPARATED = 1 << 2
+	};
+	struct CollisionEvent {
+		unsigned type = 0;
+		const cpShape* shapeA = nullptr;
+		const cpShape* shapeB = nullptr;
+		cpVect point = cpVect{ 0, 0 };
+		cpVect normal = cpVect{ 0, 0 };
+		cpFloat impulse = 0;
+	};
+	typedef std::vector<CollisionEvent> CollisionEventArray;
+	typedef std::map<CollisionKey, unsigned> CollisionEventDictionary;
+	struct Statistics {
+		bool enabled = false;
+		unsigned steps = 0;
+		double stepTime = 0.0;        // In seconds.
+		double averageStepTime = 0.0; // In seconds.
+		long long published = 0;
+	};
+	struct Broadphase {
+		bool hashed = false;
+		cpFloat dimension = 0;
+		int count = 0;
+		bool autoTune = false;
+	};
 
 	lua_State* L = nullptr;
+	bool hasty = false;
+	cpFloat accumulator = 0;
+	cpFloat alpha = 1;
+	unsigned snapshot = 0;
 	bool quitting = false;
 	bool calling = false;
 	bool querying = false;
@@ -810,6 +958,10 @@ struct SpaceData : public ReferencableData<Space::Ptr, Space::WeakPtr> {
 	CollisionHandlerDictionary handlers;
 	CollisionHandlerDictionary wildcardHandlers;
 	CollisionKey key;
+	CollisionEventDictionary eventFilters;
+	CollisionEventArray events;
+	Statistics statistics;
+	Broadphase broadphase;
 
 	SpaceData(Space::Ptr &self_, lua_State* L_) : ReferencableData(self_), L(L_) {
 	}
@@ -1022,6 +1174,81 @@ struct SpaceData : public ReferencableData<Space::Ptr, Space::WeakPtr> {
 		ScriptingLua::check(data->L, call(data->L, *handler.separateHandler, &arg1, &arg2));
 	}
 
+	static cpBool onBufferedCollisionBegan(cpArbiter* arbiter, cpSpace* space, cpDataPointer userData) {
+		SpaceData* data = SpaceData::get(space);
+		if (data->quitting)
+			return cpFalse;
+
+		data->record(arbiter, COLLISION_BEGAN);
+
+		return onCollisionBegan(arbiter, space, userData);
+	}
+	static void onBufferedCollisionPostSolved(cpArbiter* arbiter, cpSpace* space, cpDataPointer userData) {
+		SpaceData* data = SpaceData::get(space);
+		if (data->quitting)
+			return;
+
+		data->record(arbiter, COLLISION_POST_SOLVED);
+
+		onCollisionPostSolved(arbiter, space, userData);
+	}
+	static void onBufferedCollisionSeparated(cpArbiter* arbiter, cpSpace* space, cpDataPointer userData) {
+		SpaceData* data = SpaceData::get(space);
+		if (data->quitting)
+			return;
+
+		data->record(arbiter, COLLISION_SEPARATED);
+
+		onCollisionSeparated(arbiter, space, userData);
+	}
+
+	void record(cpArbiter* arbiter, unsigned type) {
+		if (events.size() >= SCRIPTING_LUA_PHYSICS_COLLISION_EVENT_MAX_COUNT)
+			return; // Dropped until drained.
+
+		cpShape* shapeA = nullptr;
+		cpShape* shapeB = nullptr;
+		cpArbiterGetShapes(arbiter, &shapeA, &shapeB);
+
+		CollisionEvent evt;
+		evt.type = type;
+		evt.shapeA = shapeA;
+		evt.shapeB = shapeB;
+		if (cpArbiterGetCount(arbiter) > 0)
+			evt.point = cpArbiterGetPointA(arbiter, 0);
+		evt.normal = cpArbiterGetNormal(arbiter);
+		if (type == COLLISION_POST_SOLVED)
+			evt.impulse = cpvlength(cpArbiterTotalImpulse(arbiter));
+		events.push_back(evt);
+	}
+
+	/**
+	 * @brief Installs the collision functions for the specific type pair,
+	 *   according to both the Lua handlers and the buffered events.
+	 */
+	static void install(cpSpace* space, const CollisionKey &key) {
+		SpaceData* data = SpaceData::get(space);
+		CollisionHandlerDictionary::const_iterator hit = data->handlers.find(key);
+		const CollisionHandler* handler_ = hit == data->handlers.end() ? nullptr : &hit->second;
+		CollisionEventDictionary::const_iterator eit = data->eventFilters.find(key);
+		const unsigned events = eit == data->eventFilters.end() ? 0 : eit->second;
+
+		cpCollisionHandler* handler = cpSpaceAddCollisionHandler(space, key.first, key.second);
+		if (events & COLLISION_BEGAN)
+			handler->beginFunc = onBufferedCollisionBegan;
+		else
+			handler->beginFunc = (handler_ && handler_->beginHandler) ? onCollisionBegan : Space_defaultBegin;
+		handler->preSolveFunc = (handler_ && handler_->preSolveHandler) ? onCollisionPreSolved : Space_defaultPreSolve;
+		if (events & COLLISION_POST_SOLVED)
+			handler->postSolveFunc = onBufferedCollisionPostSolved;
+		else
+			handler->postSolveFunc = (handler_ && handler_->postSolveHandler) ? onCollisionPostSolved : Space_defaultPostSolve;
+		if (events & COLLISION_SEPARATED)
+			handler->separateFunc = onBufferedCollisionSeparated;
+		else
+			handler->separateFunc = (handler_ && handler_->separateHandler) ? onCollisionSeparated : Space_defaultSeparate;
+	}
+
 	static cpBool onWildcardBegan(cpArbiter* arbiter, cpSpace* space, cpDataPointer userData) {
 		SpaceData* data = SpaceData::get(space);
 		if (data->quitting)
@@ -1370,6 +1597,252 @@ static void collect(cpSpace* space) {
 	);
 }
 
+/**< Broadphase. */
+
+static void reindex(cpSpace* space, cpSpatialIndex* staticShapes, cpSpatialIndex* dynamicShapes) {
+	auto copy = [] (void* obj, void* data) -> void {
+		cpShape* shape = (cpShape*)obj;
+		cpSpatialIndex* index = (cpSpatialIndex*)data;
+		cpSpatialIndexInsert(index, shape, shape->hashid);
+	};
+	cpSpatialIndexEach(space->staticShapes, copy, staticShapes);
+	cpSpatialIndexEach(space->dynamicShapes, copy, dynamicShapes);
+
+	cpSpatialIndexFree(space->staticShapes);
+	cpSpatialIndexFree(space->dynamicShapes);
+
+	space->staticShapes = staticShapes;
+	space->dynamicShapes = dynamicShapes;
+}
+
+static void useSpatialHash(cpSpace* space, cpFloat dim, int count) {
+	cpSpaceUseSpatialHash(space, dim, count);
+
+	SpaceData* spaceData = SpaceData::get(space);
+	spaceData->broadphase.hashed = true;
+	spaceData->broadphase.dimension = dim;
+	spaceData->broadphase.count = count;
+}
+
+static void useBoundingBoxTree(cpSpace* space) {
+	cpSpatialIndex* staticShapes = cpBBTreeNew((cpSpatialIndexBBFunc)cpShapeGetBB, nullptr);
+	cpSpatialIndex* dynamicShapes = cpBBTreeNew((cpSpatialIndexBBFunc)cpShapeGetBB, staticShapes);
+	cpBBTreeSetVelocityFunc(
+		dynamicShapes,
+		[] (void* obj) -> cpVect { // Same as `ShapeVelocityFunc` in "cpSpace.c".
+			cpShape* shape = (cpShape*)obj;
+
+			return cpBodyGetVelocity(cpShapeGetBody(shape));
+		}
+	);
+	reindex(space, staticShapes, dynamicShapes);
+
+	SpaceData* spaceData = SpaceData::get(space);
+	spaceData->broadphase.hashed = false;
+	spaceData->broadphase.dimension = 0;
+	spaceData->broadphase.count = 0;
+}
+
+/**
+ * @brief Chooses between the bounding box tree and the spatial hash by the
+ *   extents of the dynamic shapes; the hash suits plenty of similar sized
+ *   shapes, with cells about the average size.
+ *
+ * @return `true` if the broadphase has been changed.
+ */
+static bool tune(cpSpace* space) {
+	struct Context {
+		int count = 0;
+		cpFloat total = 0;
+		cpFloat max = 0;
+	};
+
+	if (space->locked)
+		return false;
+
+	Context context;
+	cpSpatialIndexEach(
+		space->dynamicShapes,
+		[] (void* obj, void* data) -> void {
+			const cpShape* shape = (const cpShape*)obj;
+			Context* context = (Context*)data;
+			const cpBB bb = cpShapeGetBB(shape);
+			const cpFloat extent = std::max(bb.r - bb.l, bb.t - bb.b);
+			++context->count;
+			context->total += extent;
+			context->max = std::max(context->max, extent);
+		},
+		&context
+	);
+	const int count = context.count + cpSpatialIndexCount(space->staticShapes);
+
+	SpaceData* spaceData = SpaceData::get(space);
+	const cpFloat average = context.count ? context.total / context.count : 0;
+	const bool hash =
+		count >= SCRIPTING_LUA_PHYSICS_TUNE_MIN_SHAPE_COUNT &&
+		average > 0 && context.max <= average * 4; // Similar sized.
+	if (hash) {
+		const cpFloat dim = average;
+		const int cells = std::max(count * 10, 1000);
+		const bool similar =
+			spaceData->broadphase.hashed &&
+			std::abs(spaceData->broadphase.dimension - dim) <= spaceData->broadphase.dimension * 0.25f &&
+			cells <= spaceData->broadphase.count * 2 && cells * 2 >= spaceData->broadphase.count;
+		if (similar)
+			return false;
+
+		useSpatialHash(space, dim, cells);
+
+		return true;
+	}
+
+	if (!spaceData->broadphase.hashed)
+		return false;
+
+	useBoundingBoxTree(space);
+
+	return true;
+}
+
+/**< Statistics. */
+
+static void countBodies(cpSpace* space, int &active, int &sleeping) {
+	struct Context {
+		int active = 0;
+		int sleeping = 0;
+	};
+
+	Context context;
+	cpSpaceEachBody(
+		space,
+		[] (cpBody* body, void* data) -> void {
+			Context* context = (Context*)data;
+			if (cpBodyGetType(body) == CP_BODY_TYPE_STATIC)
+				return;
+
+			if (cpBodyIsSleeping(body))
+				++context->sleeping;
+			else
+				++context->active;
+		},
+		&context
+	);
+	active = context.active;
+	sleeping = context.sleeping;
+}
+
+static int countContacts(const cpSpace* space) {
+	int result = 0;
+	for (int i = 0; i < space->arbiters->num; ++i)
+		result += cpArbiterGetCount((const cpArbiter*)space->arbiters->arr[i]);
+
+	return result;
+}
+
+static void publish(cpSpace* space) {
+	SpaceData* spaceData = SpaceData::get(space);
+	ScriptingLua* impl = ScriptingLua::instanceOf(spaceData->L);
+	if (!impl)
+		return;
+
+	char key[32];
+	snprintf(key, BITTY_COUNTOF(key), "SPACE 0x%p", (void*)space); // Unique among living spaces.
+	if (!spaceData->statistics.enabled) {
+		impl->setStatistics(key, nullptr);
+
+		return;
+	}
+
+	int active = 0, sleeping = 0;
+	countBodies(space, active, sleeping);
+
+	char val[128];
+	snprintf(
+		val, BITTY_COUNTOF(val),
+		"%.3fms, %d pairs, %d/%d bodies, %s",
+		spaceData->statistics.averageStepTime * 1000.0,
+		space->arbiters->num,
+		active, active + sleeping,
+		spaceData->broadphase.hashed ? "hash" : "tree"
+	);
+	impl->setStatistics(key, val);
+}
+
+/**< Stepper. */
+
+static void step(cpSpace* space, cpFloat delta) {
+	SpaceData* spaceData = SpaceData::get(space);
+
+	const long long begin = DateTime::ticks();
+
+#if SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED
+	if (spaceData->hasty)
+		cpHastySpaceStep(space, delta);
+	else
+		cpSpaceStep(space, delta);
+#else /* SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED */
+	cpSpaceStep(space, delta);
+#endif /* SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED */
+
+	const long long end = DateTime::ticks();
+	SpaceData::Statistics &stat = spaceData->statistics;
+	stat.stepTime = DateTime::toSeconds(end - begin);
+	if (stat.steps++ == 0)
+		stat.averageStepTime = stat.stepTime;
+	else
+		stat.averageStepTime += (stat.stepTime - stat.averageStepTime) * 0.1; // Moving average.
+	if (stat.enabled && end - stat.published >= SCRIPTING_LUA_PHYSICS_STATISTICS_INTERVAL_NANOSECONDS) {
+		stat.published = end;
+		publish(space);
+	}
+
+	if (spaceData->broadphase.autoTune && stat.steps % SCRIPTING_LUA_PHYSICS_TUNE_INTERVAL_STEP_COUNT == 0)
+		tune(space);
+
+	if (spaceData->obsoleteCollectEnabled) {
+		if (spaceData->obsoleteObjectCount >= spaceData->obsoleteCollectThreshold) {
+			collect(space);
+			spaceData->obsoleteObjectCount = 0;
+		}
+	}
+}
+
+static void snapshot(cpSpace* space) {
+	SpaceData* spaceData = SpaceData::get(space);
+	++spaceData->snapshot;
+	cpSpaceEachBody(
+		space,
+		[] (cpBody* body, void* data) -> void {
+			BodyData* bodyData = BodyData::get(body);
+			if (!bodyData)
+				return;
+
+			const SpaceData* spaceData = (const SpaceData*)data;
+			bodyData->previousPosition = cpBodyGetPosition(body);
+			bodyData->previousAngle = cpBodyGetAngle(body);
+			bodyData->snapshot = spaceData->snapshot;
+		},
+		spaceData
+	);
+}
+
+static void interpolate(const cpBody* body, cpVect &pos, cpFloat &angle) {
+	pos = cpBodyGetPosition(body);
+	angle = cpBodyGetAngle(body);
+
+	const cpSpace* space = cpBodyGetSpace(body);
+	const SpaceData* spaceData = SpaceData::get(space);
+	const BodyData* bodyData = BodyData::get(body);
+	if (!spaceData || !bodyData)
+		return;
+	if (bodyData->snapshot != spaceData->snapshot || spaceData->snapshot == 0)
+		return; // Added after the latest snapshot.
+
+	const cpFloat alpha = spaceData->alpha;
+	pos = cpvlerp(bodyData->previousPosition, pos, alpha);
+	angle = bodyData->previousAngle + (angle - bodyData->previousAngle) * alpha;
+}
+
 }
 
 }
@@ -5609,6 +6082,12 @@ static void Space_dtor(cpSpace* space) {
 	SpaceData* spaceData = SpaceData::get(space);
 	spaceData->quitting = true;
 
+	// Remove the statistics.
+	if (spaceData->statistics.enabled) {
+		spaceData->statistics.enabled = false;
+		publish(space);
+	}
+
 	// Dispose the static body.
 	cpBody* staticBody = cpSpaceGetStaticBody(space);
 	if (staticBody) {
@@ -5751,17 +6230,57 @@ static void Space_dtor(cpSpace* space) {
 
 	// Dispose the space.
 	SpaceData* data = SpaceData::get(space);
+	const bool hasty = data->hasty;
 	delete data;
 
+#if SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED
+	if (hasty)
+		cpHastySpaceFree(space);
+	else
+		cpSpaceFree(space);
+#else /* SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED */
+	(void)hasty;
+
 	cpSpaceFree(space);
+#endif /* SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED */
 }
 
 static int Space_ctor(lua_State* L) {
+	const int n = getTop(L);
+	lua_Integer threads = 1;
+	if (n >= 1 && isTable(L, 1)) {
+		lua_pushvalue(L, 1);
+		getTable(L, "threads", threads);
+		pop(L);
+	}
+	if (threads < 0) {
+		error(L, "Invalid thread count.");
+
+		return 0;
+	}
+	if (threads == 0) // Automatic.
+		threads = (lua_Integer)std::max(std::thread::hardware_concurrency(), 1u);
+
+#if SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED
+	const bool hasty = threads > 1;
+	cpSpace* ptr = nullptr;
+	if (hasty) {
+		ptr = cpHastySpaceNew();
+		cpHastySpaceSetThreads(ptr, (unsigned long)threads);
+	} else {
+		ptr = cpSpaceNew();
+	}
+#else /* SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED */
+	const bool hasty = false;
+	cpSpace* ptr = cpSpaceNew();
+#endif /* SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED */
+
 	Space::Ptr obj(
-		cpSpaceNew(),
+		ptr,
 		Space_dtor
 	);
 	SpaceData* data = new SpaceData(obj, L);
+	data->hasty = hasty;
 	cpSpaceSetUserData(obj.get(), data);
 
 	return write(L, &obj);
@@ -5882,16 +6401,68 @@ static int Space_setCollisionHandler(lua_State* L) {
 			);
 		}
 
-		cpCollisionHandler* handler = cpSpaceAddCollisionHandler(obj->get(), typeA, typeB);
-		handler->beginFunc = onBegan ? SpaceData::onCollisionBegan : Space_defaultBegin;
-		handler->preSolveFunc = onPreSolved ? SpaceData::onCollisionPreSolved : Space_defaultPreSolve;
-		handler->postSolveFunc = onPostSolved ? SpaceData::onCollisionPostSolved : Space_defaultPostSolve;
-		handler->separateFunc = onSeparated ? SpaceData::onCollisionSeparated : Space_defaultSeparate;
+		SpaceData::install(obj->get(), key);
 	}
 
 	return 0;
 }
 
+static int Space_setCollisionEvents(lua_State* L) {
+	const int n = getTop(L);
+	Space::Ptr* obj = nullptr;
+	cpCollisionType typeA = 0, typeB = 0;
+	unsigned events = 0;
+	if (n >= 4)
+		read<>(L, obj, typeA, typeB, events);
+	else
+		read<>(L, obj, typeA, typeB);
+
+	if (obj && obj->get()) {
+		SpaceData* data = SpaceData::get(obj->get());
+		const SpaceData::CollisionKey key(typeA, typeB);
+		if (events)
+			data->eventFilters[key] = events;
+		else
+			data->eventFilters.erase(key);
+
+		SpaceData::install(obj->get(), key);
+	}
+
+	return 0;
+}
+
+static int Space_drainCollisionEvents(lua_State* L) {
+	Space::Ptr* obj = nullptr;
+	Bytes::Ptr* bytes = nullptr;
+	read<>(L, obj, bytes);
+
+	if (obj && obj->get() && bytes && bytes->get()) {
+		constexpr const size_t RESULT_STRIDE = 8; // Event, id A, id B, x, y, normal x, normal y, impulse.
+
+		SpaceData* data = SpaceData::get(obj->get());
+		Bytes* ptr = bytes->get();
+		ptr->resize(data->events.size() * RESULT_STRIDE * sizeof(Double));
+		ptr->poke(0);
+		Byte* output = ptr->pointer();
+		for (const SpaceData::CollisionEvent &evt : data->events) {
+			Packed::write(output, (Double)evt.type);
+			Packed::write(output, (Double)(uintptr_t)evt.shapeA);
+			Packed::write(output, (Double)(uintptr_t)evt.shapeB);
+			Packed::write(output, (Double)evt.point.x);
+			Packed::write(output, (Double)evt.point.y);
+			Packed::write(output, (Double)evt.normal.x);
+			Packed::write(output, (Double)evt.normal.y);
+			Packed::write(output, (Double)evt.impulse);
+		}
+		const size_t ret = data->events.size();
+		data->events.clear();
+
+		return write(L, ret);
+	}
+
+	return write(L, nullptr);
+}
+
 static int Space_setWildcardHandler(lua_State* L) {
 	const int n = getTop(L);
 	Space::Ptr* obj = nullptr;
@@ -6618,6 +7189,176 @@ static int Space_shapeQueryAll(lua_State* L) {
 	return write(L, nullptr);
 }
 
+static int Space_pointQueryBatch(lua_State* L) {
+	const int n = getTop(L);
+	Space::Ptr* obj = nullptr;
+	Bytes::Ptr* queries = nullptr;
+	Bytes::Ptr* results = nullptr;
+	cpFloat maxDistance = 0;
+	ShapeFilter::Ptr* filter = nullptr;
+	if (n >= 5)
+		read<>(L, obj, queries, results, maxDistance, filter);
+	else
+		read<>(L, obj, queries, results, maxDistance);
+
+	if (obj && obj->get() && queries && queries->get() && results && results->get()) {
+		if (queries->get() == results->get()) {
+			error(L, "Cannot write to self.");
+
+			return 0;
+		}
+
+		constexpr const size_t QUERY_STRIDE = 2; // x, y.
+		constexpr const size_t RESULT_STRIDE = 4; // id, x, y, distance.
+
+		const cpShapeFilter filter_ = (filter && filter->get()) ? *filter->get() : CP_SHAPE_FILTER_ALL;
+		const size_t count = Packed::count(queries->get(), QUERY_STRIDE);
+		results->get()->resize(count * RESULT_STRIDE * sizeof(Double));
+		results->get()->poke(0);
+		const Byte* cursor = queries->get()->pointer();
+		Byte* output = results->get()->pointer();
+		int ret = 0;
+		for (size_t i = 0; i < count; ++i) {
+			cpVect point;
+			point.x = (cpFloat)Packed::read(cursor);
+			point.y = (cpFloat)Packed::read(cursor);
+			cpPointQueryInfo info;
+			cpShape* shape = cpSpacePointQueryNearest(obj->get(), point, maxDistance, filter_, &info);
+			if (shape) {
+				Packed::write(output, (Double)(uintptr_t)shape);
+				Packed::write(output, (Double)info.point.x);
+				Packed::write(output, (Double)info.point.y);
+				Packed::write(output, (Double)info.distance);
+				++ret;
+			} else {
+				Packed::write(output, 0);
+				Packed::write(output, 0);
+				Packed::write(output, 0);
+				Packed::write(output, 0);
+			}
+		}
+
+		return write(L, ret);
+	}
+
+	return write(L, nullptr);
+}
+
+static int Space_segmentQueryBatch(lua_State* L) {
+	const int n = getTop(L);
+	Space::Ptr* obj = nullptr;
+	Bytes::Ptr* queries = nullptr;
+	Bytes::Ptr* results = nullptr;
+	cpFloat radius = 0;
+	ShapeFilter::Ptr* filter = nullptr;
+	if (n >= 5)
+		read<>(L, obj, queries, results, radius, filter);
+	else if (n >= 4)
+		read<>(L, obj, queries, results, radius);
+	else
+		read<>(L, obj, queries, results);
+
+	if (obj && obj->get() && queries && queries->get() && results && results->get()) {
+		if (queries->get() == results->get()) {
+			error(L, "Cannot write to self.");
+
+			return 0;
+		}
+
+		constexpr const size_t QUERY_STRIDE = 4; // x0, y0, x1, y1.
+		constexpr const size_t RESULT_STRIDE = 6; // id, x, y, normal x, normal y, alpha.
+
+		const cpShapeFilter filter_ = (filter && filter->get()) ? *filter->get() : CP_SHAPE_FILTER_ALL;
+		const size_t count = Packed::count(queries->get(), QUERY_STRIDE);
+		results->get()->resize(count * RESULT_STRIDE * sizeof(Double));
+		results->get()->poke(0);
+		const Byte* cursor = queries->get()->pointer();
+		Byte* output = results->get()->pointer();
+		int ret = 0;
+		for (size_t i = 0; i < count; ++i) {
+			cpVect start, end;
+			start.x = (cpFloat)Packed::read(cursor);
+			start.y = (cpFloat)Packed::read(cursor);
+			end.x = (cpFloat)Packed::read(cursor);
+			end.y = (cpFloat)Packed::read(cursor);
+			cpSegmentQueryInfo info;
+			cpShape* shape = cpSpaceSegmentQueryFirst(obj->get(), start, end, radius, filter_, &info);
+			if (shape) {
+				Packed::write(output, (Double)(uintptr_t)shape);
+				Packed::write(output, (Double)info.point.x);
+				Packed::write(output, (Double)info.point.y);
+				Packed::write(output, (Double)info.normal.x);
+				Packed::write(output, (Double)info.normal.y);
+				Packed::write(output, (Double)info.alpha);
+				++ret;
+			} else {
+				Packed::write(output, 0);
+				Packed::write(output, (Double)end.x);
+				Packed::write(output, (Double)end.y);
+				Packed::write(output, 0);
+				Packed::write(output, 0);
+				Packed::write(output, 1);
+			}
+		}
+
+		return write(L, ret);
+	}
+
+	return write(L, nullptr);
+}
+
+static int Space_boundingBoxQueryBatch(lua_State* L) {
+	const int n = getTop(L);
+	Space::Ptr* obj = nullptr;
+	Bytes::Ptr* queries = nullptr;
+	Bytes::Ptr* results = nullptr;
+	ShapeFilter::Ptr* filter = nullptr;
+	if (n >= 4)
+		read<>(L, obj, queries, results, filter);
+	else
+		read<>(L, obj, queries, results);
+
+	if (obj && obj->get() && queries && queries->get() && results && results->get()) {
+		constexpr const size_t QUERY_STRIDE = 4; // x0, y0, x1, y1.
+
+		struct Context {
+			std::vector<Double> hits; // Pairs of query index, id.
+			Double index = 0;
+		};
+
+		const cpShapeFilter filter_ = (filter && filter->get()) ? *filter->get() : CP_SHAPE_FILTER_ALL;
+		const size_t count = Packed::count(queries->get(), QUERY_STRIDE);
+		const Byte* cursor = queries->get()->pointer();
+		Context context;
+		for (size_t i = 0; i < count; ++i) {
+			const cpFloat x0 = (cpFloat)Packed::read(cursor);
+			const cpFloat y0 = (cpFloat)Packed::read(cursor);
+			const cpFloat x1 = (cpFloat)Packed::read(cursor);
+			const cpFloat y1 = (cpFloat)Packed::read(cursor);
+			const cpBB bb = cpBB{ std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1) };
+			context.index = (Double)(i + 1); // 1-based.
+			cpSpaceBBQuery(
+				obj->get(), bb, filter_,
+				[] (cpShape* shape, void* data) -> void {
+					Context* context = (Context*)data;
+					context->hits.push_back(context->index);
+					context->hits.push_back((Double)(uintptr_t)shape);
+				},
+				&context
+			);
+		}
+
+		results->get()->resize(context.hits.size() * sizeof(Double));
+		results->get()->poke(0);
+		if (!context.hits.empty())
+			memcpy(results->get()->pointer(), &context.hits.front(), context.hits.size() * sizeof(Double));
+
+		return write(L, context.hits.size() / 2);
+	}
+
+	return write(L, nullptr);
+}
+
 static int Space_query(lua_State* L) {
 	Math::Vec2f* arg2_Vect = nullptr;
 	Math::Vec2f* arg3_Vect = nullptr;
@@ -6778,7 +7519,27 @@ static int Space_useSpatialHash(lua_State* L) {
 	read<>(L, obj, dim, count);
 
 	if (obj && obj->get())
-		cpSpaceUseSpatialHash(obj->get(), dim, count);
+		useSpatialHash(obj->get(), dim, count);
+
+	return 0;
+}
+
+static int Space_tune(lua_State* L) {
+	const int n = getTop(L);
+	Space::Ptr* obj = nullptr;
+	bool autoTune = false;
+	if (n >= 2)
+		read<>(L, obj, autoTune);
+	else
+		read<>(L, obj);
+
+	if (obj && obj->get()) {
+		SpaceData* spaceData = SpaceData::get(obj->get());
+		spaceData->broadphase.autoTune = autoTune;
+		tune(obj->get());
+
+		return write(L, spaceData->broadphase.hashed ? "hash" : "tree");
+	}
 
 	return 0;
 }
@@ -6788,16 +7549,238 @@ static int Space_step(lua_State* L) {
 	cpFloat delta = 0;
 	read<>(L, obj, delta);
 
-	if (obj && obj->get()) {
-		cpSpaceStep(obj->get(), delta);
+	if (obj && obj->get())
+		step(obj->get(), delta);
+
+	return 0;
+}
 
+static int Space_advance(lua_State* L) {
+	const int n = getTop(L);
+	Space::Ptr* obj = nullptr;
+	cpFloat delta = 0;
+	cpFloat fixedDelta = 0;
+	int maxSteps = SCRIPTING_LUA_PHYSICS_ADVANCE_MAX_STEP_COUNT;
+	if (n >= 4)
+		read<>(L, obj, delta, fixedDelta, maxSteps);
+	else
+		read<>(L, obj, delta, fixedDelta);
+
+	if (fixedDelta <= 0) {
+		error(L, "Invalid step.");
+
+		return 0;
+	}
+	if (delta < 0)
+		delta = 0;
+	if (maxSteps < 1)
+		maxSteps = 1;
+
+	if (obj && obj->get()) {
 		SpaceData* spaceData = SpaceData::get(obj->get());
-		if (spaceData->obsoleteCollectEnabled) {
-			if (spaceData->obsoleteObjectCount >= spaceData->obsoleteCollectThreshold) {
-				collect(obj->get());
-				spaceData->obsoleteObjectCount = 0;
+
+		spaceData->accumulator += delta;
+		int steps = 0;
+		while (spaceData->accumulator >= fixedDelta && steps < maxSteps) {
+			snapshot(obj->get());
+			step(obj->get(), fixedDelta);
+			spaceData->accumulator -= fixedDelta;
+			++steps;
+		}
+		if (spaceData->accumulator >= fixedDelta) // Drop the backlog instead of spiraling.
+			spaceData->accumulator = std::fmod(spaceData->accumulator, fixedDelta);
+		spaceData->alpha = spaceData->accumulator / fixedDelta;
+
+		return write(L, steps, spaceData->alpha);
+	}
+
+	return 0;
+}
+
+static int Space_interpolate(lua_State* L) {
+	Space::Ptr* obj = nullptr;
+	Body::Ptr* body = nullptr;
+	read<>(L, obj, body);
+
+	if (obj && obj->get() && body && body->get()) {
+		cpVect pos;
+		cpFloat angle = 0;
+		interpolate(body->get(), pos, angle);
+
+		return write(L, pos, angle);
+	}
+
+	return write(L, nullptr, nullptr);
+}
+
+static bool Space_readBodyFields(lua_State* L, BodyState::Array &fields, Index idx) {
+	fields.clear();
+	if (isNoneOrNil(L, idx)) {
+		fields.push_back(BodyState::ID);
+		fields.push_back(BodyState::X);
+		fields.push_back(BodyState::Y);
+		fields.push_back(BodyState::ANGLE);
+
+		return true;
+	}
+	if (!isArray(L, idx))
+		return false;
+
+	const lua_Unsigned size = len(L, idx);
+	for (int i = 1; i <= (int)size; ++i) { // 1-based.
+		get(L, idx, i);
+
+		const char* name = nullptr;
+		read<-1>(L, name);
+		BodyState::Fields field;
+		const bool ok = name && BodyState::parse(name, field);
+
+		pop(L, 1);
+
+		if (!ok)
+			return false;
+		fields.push_back(field);
+	}
+
+	return !fields.empty();
+}
+
+static int Space_exportBodies(lua_State* L) {
+	Space::Ptr* obj = nullptr;
+	Bytes::Ptr* bytes = nullptr;
+	read<>(L, obj, bytes);
+	BodyState::Array fields;
+	if (!Space_readBodyFields(L, fields, Index(3))) {
+		error(L, "Invalid body field.");
+
+		return 0;
+	}
+
+	if (obj && obj->get() && bytes && bytes->get()) {
+		struct Context {
+			const BodyState::Array* fields = nullptr;
+			Byte* cursor = nullptr;
+			size_t count = 0;
+		};
+
+		Context context;
+		cpSpaceEachBody(
+			obj->get(),
+			[] (cpBody*, void* data) -> void {
+				Context* context = (Context*)data;
+				++context->count;
+			},
+			&context
+		);
+
+		Bytes* ptr = bytes->get();
+		ptr->resize(context.count * fields.size() * sizeof(Double));
+		ptr->poke(0);
+		if (context.count == 0)
+			return write(L, 0);
+
+		context.fields = &fields;
+		context.cursor = ptr->pointer();
+		cpSpaceEachBody(
+			obj->get(),
+			[] (cpBody* body, void* data) -> void {
+				Context* context = (Context*)data;
+				const cpVect pos = cpBodyGetPosition(body);
+				const cpVect vel = cpBodyGetVelocity(body);
+				cpVect ipos;
+				cpFloat iangle = 0;
+				interpolate(body, ipos, iangle);
+				for (BodyState::Fields field : *context->fields) {
+					Double val = 0;
+					switch (field) {
+					case BodyState::ID: val = (Double)(uintptr_t)body; break;
+					case BodyState::X: val = (Double)pos.x; break;
+					case BodyState::Y: val = (Double)pos.y; break;
+					case BodyState::ANGLE: val = (Double)cpBodyGetAngle(body); break;
+					case BodyState::VX: val = (Double)vel.x; break;
+					case BodyState::VY: val = (Double)vel.y; break;
+					case BodyState::SLEEPING: val = cpBodyIsSleeping(body) ? 1 : 0; break;
+					case BodyState::INTERPOLATED_X: val = (Double)ipos.x; break;
+					case BodyState::INTERPOLATED_Y: val = (Double)ipos.y; break;
+					case BodyState::INTERPOLATED_ANGLE: val = (Double)iangle; break;
+					default: /* Do nothing. */ break;
+					}
+					Packed::write(context->cursor, val);
+				}
+			},
+			&context
+		);
+
+		return write(L, context.count);
+	}
+
+	return 0;
+}
+
+static int Space_importBodies(lua_State* L) {
+	Space::Ptr* obj = nullptr;
+	Bytes::Ptr* bytes = nullptr;
+	read<>(L, obj, bytes);
+	BodyState::Array fields;
+	if (!Space_readBodyFields(L, fields, Index(3))) {
+		error(L, "Invalid body field.");
+
+		return 0;
+	}
+	if (std::find(fields.begin(), fields.end(), BodyState::ID) == fields.end()) {
+		error(L, "Body field \"id\" expected.");
+
+		return 0;
+	}
+
+	if (obj && obj->get() && bytes && bytes->get()) {
+		typedef std::unordered_map<uintptr_t, cpBody*> Bodies;
+
+		Bodies bodies;
+		cpSpaceEachBody(
+			obj->get(),
+			[] (cpBody* body, void* data) -> void {
+				if (cpBodyGetType(body) != CP_BODY_TYPE_KINEMATIC)
+					return;
+
+				Bodies* bodies = (Bodies*)data;
+				(*bodies)[(uintptr_t)body] = body;
+			},
+			&bodies
+		);
+
+		const Bytes* ptr = bytes->get();
+		const size_t n = Packed::count(ptr, fields.size());
+		const Byte* cursor = ptr->pointer();
+		size_t count = 0;
+		Double record[BodyState::COUNT];
+		for (size_t i = 0; i < n; ++i) {
+			for (BodyState::Fields field : fields)
+				record[field] = Packed::read(cursor);
+
+			Bodies::iterator it = bodies.find((uintptr_t)record[BodyState::ID]);
+			if (it == bodies.end())
+				continue;
+
+			cpBody* body = it->second;
+			cpVect pos = cpBodyGetPosition(body);
+			cpVect vel = cpBodyGetVelocity(body);
+			for (BodyState::Fields field : fields) {
+				switch (field) {
+				case BodyState::X: pos.x = (cpFloat)record[field]; break;
+				case BodyState::Y: pos.y = (cpFloat)record[field]; break;
+				case BodyState::ANGLE: cpBodySetAngle(body, (cpFloat)record[field]); break;
+				case BodyState::VX: vel.x = (cpFloat)record[field]; break;
+				case BodyState::VY: vel.y = (cpFloat)record[field]; break;
+				default: /* Do nothing. */ break;
+				}
 			}
+			cpBodySetPosition(body, pos);
+			cpBodySetVelocity(body, vel);
+			++count;
 		}
+
+		return write(L, count);
 	}
 
 	return 0;
@@ -6857,6 +7840,15 @@ static int Space___index(lua_State* L) {
 	if (strcmp(field, "id") == 0) {
 		const uintptr_t ret = (uintptr_t)obj->get();
 
+		return write(L, ret);
+	} else if (strcmp(field, "threads") == 0) {
+#if SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED
+		SpaceData* spaceData = SpaceData::get(obj->get());
+		const lua_Integer ret = spaceData->hasty ? (lua_Integer)cpHastySpaceGetThreads(obj->get()) : 1;
+#else /* SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED */
+		const lua_Integer ret = 1;
+#endif /* SCRIPTING_LUA_PHYSICS_HASTY_SPACE_ENABLED */
+
 		return write(L, ret);
 	} else if (strcmp(field, "iterations") == 0) {
 		const int ret = cpSpaceGetIterations(obj->get());
@@ -6909,6 +7901,41 @@ static int Space___index(lua_State* L) {
 		}
 
 		return write(L, &ret);
+	} else if (strcmp(field, "alpha") == 0) {
+		SpaceData* spaceData = SpaceData::get(obj->get());
+		const cpFloat ret = spaceData->alpha;
+
+		return write(L, ret);
+	} else if (strcmp(field, "statistics") == 0) {
+		SpaceData* spaceData = SpaceData::get(obj->get());
+		const SpaceData::Statistics &stat = spaceData->statistics;
+		const SpaceData::Broadphase &broadphase = spaceData->broadphase;
+		int active = 0, sleeping = 0;
+		countBodies(obj->get(), active, sleeping);
+
+		newTable(L);
+		setTable(
+			L,
+			"steps", stat.steps,
+			"stepTime", stat.stepTime,
+			"averageStepTime", stat.averageStepTime,
+			"shapes", cpSpatialIndexCount(obj->get()->staticShapes) + cpSpatialIndexCount(obj->get()->dynamicShapes),
+			"activeBodies", active,
+			"sleepingBodies", sleeping,
+			"pairs", obj->get()->arbiters->num,
+			"contacts", countContacts(obj->get()),
+			"broadphase", broadphase.hashed ? "hash" : "tree",
+			"hashDimension", broadphase.dimension,
+			"hashCount", broadphase.count,
+			"autoTune", broadphase.autoTune
+		);
+
+		return 1;
+	} else if (strcmp(field, "statisticsEnabled") == 0) {
+		SpaceData* spaceData = SpaceData::get(obj->get());
+		const bool ret = spaceData->statistics.enabled;
+
+		return write(L, ret);
 	} else if (strcmp(field, "currentTimeStep") == 0) {
 		const cpFloat ret = cpSpaceGetCurrentTimeStep(obj->get());
 
@@ -7022,6 +8049,18 @@ static int Space___newindex(lua_State* L) {
 		read<3>(L, val);
 
 		cpSpaceSetCollisionPersistence(obj->get(), val);
+	} else if (strcmp(field, "statisticsEnabled") == 0) {
+		bool val = false;
+		read<3>(L, val);
+
+		SpaceData* spaceData = SpaceData::get(obj->get());
+		if (spaceData->statistics.enabled == val)
+			return 0;
+
+		spaceData->statistics.enabled = val;
+		spaceData->statistics.published = 0;
+		if (!val)
+			publish(obj->get()); // Remove.
 	}
 
 	return 0;
@@ -7046,6 +8085,8 @@ static void open_Space(lua_State* L) {
 			luaL_Reg{ "setDefaultCollisionHandler", Space_setDefaultCollisionHandler },
 			luaL_Reg{ "setCollisionHandler", Space_setCollisionHandler },
 			luaL_Reg{ "setWildcardHandler", Space_setWildcardHandler },
+			luaL_Reg{ "setCollisionEvents", Space_setCollisionEvents },
+			luaL_Reg{ "drainCollisionEvents", Space_drainCollisionEvents },
 			luaL_Reg{ "addShape", Space_addShape },
 			luaL_Reg{ "removeShape", Space_removeShape },
 			luaL_Reg{ "hasShape", Space_hasShape },
@@ -7065,6 +8106,9 @@ static void open_Space(lua_State* L) {
 			luaL_Reg{ "boundingBoxQueryAll", Space_boundingBoxQueryAll },
 			luaL_Reg{ "shapeQuery", Space_shapeQuery },
 			luaL_Reg{ "shapeQueryAll", Space_shapeQueryAll },
+			luaL_Reg{ "pointQueryBatch", Space_pointQueryBatch },
+			luaL_Reg{ "segmentQueryBatch", Space_segmentQueryBatch },
+			luaL_Reg{ "boundingBoxQueryBatch", Space_boundingBoxQueryBatch },
 			luaL_Reg{ "query", Space_query },
 			//luaL_Reg{ "foreachBody", Space_foreachBody<2> },
 			//luaL_Reg{ "foreachShape", Space_foreachShape<2> },
@@ -7074,7 +8118,12 @@ static void open_Space(lua_State* L) {
 			luaL_Reg{ "reindexShape", Space_reindexShape },
 			luaL_Reg{ "reindexShapesForBody", Space_reindexShapesForBody },
 			luaL_Reg{ "useSpatialHash", Space_useSpatialHash },
+			luaL_Reg{ "tune", Space_tune },
 			luaL_Reg{ "step", Space_step },
+			luaL_Reg{ "advance", Space_advance },
+			luaL_Reg{ "interpolate", Space_interpolate },
+			luaL_Reg{ "exportBodies", Space_exportBodies },
+			luaL_Reg{ "importBodies", Space_importBodies },
 			luaL_Reg{ "collect", Space_collect },
 			luaL_Reg{ nullptr, nullptr }
 		),
@@ -7235,6 +8284,9 @@ static void open_Physics(lua_State* L) {
 		"NoGroup", CP_NO_GROUP,
 		"AllCategories", CP_ALL_CATEGORIES,
 		"WildcardCollisionType", CP_WILDCARD_COLLISION_TYPE,
+		"CollisionBegan", (unsigned)SpaceData::COLLISION_BEGAN,
+		"CollisionPostSolved", (unsigned)SpaceData::COLLISION_POST_SOLVED,
+		"CollisionSeparated", (unsigned)SpaceData::COLLISION_SEPARATED,
 
 		"momentForCircle", Physics_momentForCircle,
 		"areaForCircle", Physics_areaForCircle,
@@ -10,12 +10,20 @@
 
 #include "bitty.h"
 #include "bytes.h"
+#include "code.h"
 #include "datetime.h"
 #include "filesystem.h"
 #include "json.h"
+#include "platform.h"
+#include "project.h"
 #include "scripting_lua.h"
 #include "scripting_lua_api_promises.h"
 #include "web.h"
+#include <map>
+#if BITTY_MULTITHREAD_ENABLED
+#	include <condition_variable>
+#	include <thread>
+#endif /* BITTY_MULTITHREAD_ENABLED */
 #if defined BITTY_CP_VC
 #	pragma warning(push)
 #	pragma warning(disable : 4800)
@@ -35,6 +43,23 @@
 #	include <emscripten.h>
 #endif /* BITTY_OS_HTML */
 
+/*
+** {===========================================================================
+** Macros and constants
+*/
+
+#ifndef SCRIPTING_LUA_WORKER_FUNCTION_NAME
+#	define SCRIPTING_LUA_WORKER_FUNCTION_NAME "work"
+#endif /* SCRIPTING_LUA_WORKER_FUNCTION_NAME */
+#ifndef SCRIPTING_LUA_WORKER_THREAD_MAX_COUNT
+#	define SCRIPTING_LUA_WORKER_THREAD_MAX_COUNT 8
+#endif /* SCRIPTING_LUA_WORKER_THREAD_MAX_COUNT */
+#ifndef SCRIPTING_LUA_WORKER_HOOK_INSTRUCTION_COUNT
+#	define SCRIPTING_LUA_WORKER_HOOK_INSTRUCTION_COUNT 1000
+#endif /* SCRIPTING_LUA_WORKER_HOOK_INSTRUCTION_COUNT */
+
+/* ===========================================================================} */
+
 /*
 ** {===========================================================================
 ** Utilities
@@ -92,6 +117,574 @@ EM_JS(
 
 /* ===========================================================================} */
 
+/*
+** {===========================================================================
+** Worker
+*/
+
+/**
+ * @brief Isolated Lua state that runs a code asset off the Lua thread, and
+ *   communicates with it by copied messages only.
+ */
+class Worker : public Updatable, public NonCopyable {
+#if BITTY_MULTITHREAD_ENABLED
+	friend class WorkerPool;
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+public:
+	typedef std::shared_ptr<Worker> Ptr;
+
+	struct ReceivedHandler : public Handler<ReceivedHandler, void, ReceivedHandler*, const Variant &> {
+		using Handler::Handler;
+	};
+
+private:
+	struct Message {
+		UInt32 id = 0; // Zero for messages posted by the worker itself.
+		Variant data = nullptr;
+		bool ok = true;
+
+		Message() {
+		}
+		Message(UInt32 id_, const Variant &data_, bool ok_) : id(id_), data(data_), ok(ok_) {
+		}
+	};
+	typedef std::list<Message> Messages;
+
+	typedef std::map<UInt32, Promise::Ptr> Pending;
+	typedef std::list<Promise::Ptr> Settled;
+
+private:
+	ScriptingLua* _impl = nullptr;
+#if BITTY_MULTITHREAD_ENABLED
+	std::shared_ptr<class WorkerPool> _pool = nullptr;
+#endif /* BITTY_MULTITHREAD_ENABLED */
+	std::string _name;
+
+	lua_State* _L = nullptr;                 // By the pool threads.
+	std::string _source;                     // By the pool threads.
+	std::string _error;                      // By the pool threads.
+	bool _loaded = false;                    // By the pool threads.
+
+	Messages _inbox;                         // By the Lua, pool threads.
+	Mutex _inboxLock;
+	Messages _outbox;                        // By the Lua, pool threads.
+	Mutex _outboxLock;
+	Atomic<bool> _terminated;                // By the Lua, pool threads.
+
+	bool _scheduled = false;                 // By the Lua, pool threads, guarded by the pool.
+	bool _running = false;                   // By the Lua, pool threads, guarded by the pool.
+
+	UInt32 _seed = 0;                        // By the Lua thread.
+	Pending _pending;                        // By the Lua thread.
+	Settled _settled;                        // By the Lua thread.
+	ReceivedHandler _rcvHandler;             // By the Lua thread.
+
+public:
+	Worker(ScriptingLua* impl, const std::string &name, const std::string &source);
+	virtual ~Worker();
+
+	const std::string &name(void) const;
+	int pending(void) const;
+	bool terminated(void) const;
+
+	/**
+	 * @brief Posts a message to the worker, the promise is resolved with what its
+	 *   `work` function returns, or rejected with the error.
+	 */
+	bool post(const Variant &msg, Promise::Ptr promise);
+	void terminate(void);
+
+	virtual bool update(double delta) override;
+
+	void callback(const ReceivedHandler &cb);
+
+	/**
+	 * @brief Reads a message off a Lua stack, `Bytes` and `Json` are copied, or
+	 *   moved out of the source object if `transfer` is set and it is unique.
+	 */
+	static void readMessage(lua_State* L, Lua::Index idx, bool transfer, Variant &ret);
+	static int writeMessage(lua_State* L, const Variant &val);
+
+private:
+	bool load(void);
+	void process(void);
+	bool hasMessage(void);
+	void respond(UInt32 id, const Variant &data, bool ok);
+
+	static Worker* instanceOf(lua_State* L);
+
+	static int emit(lua_State* L);
+
+	static void hook(lua_State* L, lua_Debug* ar);
+};
+
+#if BITTY_MULTITHREAD_ENABLED
+/**
+ * @brief Threads shared by all workers, alive as long as any worker exists.
+ */
+class WorkerPool : public NonCopyable {
+public:
+	typedef std::shared_ptr<WorkerPool> Ptr;
+	typedef std::weak_ptr<WorkerPool> WeakPtr;
+
+private:
+	typedef std::list<Worker*> Queue;
+	typedef std::vector<std::thread> Threads;
+
+private:
+	Queue _queue;
+	Threads _threads;
+	bool _stopping = false;
+	std::condition_variable_any _signal;
+	std::condition_variable_any _idle;
+	Mutex _lock;
+
+public:
+	WorkerPool() {
+		unsigned n = std::thread::hardware_concurrency();
+		n = n > 1 ? n - 1 : 1; // Leave a core for the Lua thread.
+		n = std::min(n, (unsigned)SCRIPTING_LUA_WORKER_THREAD_MAX_COUNT);
+		for (unsigned i = 0; i < n; ++i)
+			_threads.push_back(std::thread(proc, this));
+	}
+	~WorkerPool() {
+		do {
+			LockGuard<decltype(_lock)> guard(_lock);
+
+			_stopping = true;
+		} while (false);
+		_signal.notify_all();
+
+		for (std::thread &thread : _threads) {
+			if (thread.joinable())
+				thread.join();
+		}
+		_threads.clear();
+		_queue.clear();
+	}
+
+	void schedule(Worker* worker) {
+		LockGuard<decltype(_lock)> guard(_lock);
+
+		if (worker->_scheduled || worker->_running)
+			return; // A running worker is rescheduled when it finishes, if there are still messages.
+
+		worker->_scheduled = true;
+		_queue.push_back(worker);
+		_signal.notify_one();
+	}
+	void unschedule(Worker* worker) {
+		std::unique_lock<decltype(_lock)> guard(_lock);
+
+		_queue.remove(worker);
+		worker->_scheduled = false;
+
+		_idle.wait(guard, [worker] (void) -> bool { return !worker->_running; });
+	}
+
+	static Ptr acquire(void) {
+		static Mutex lock;
+		static WeakPtr instance;
+
+		LockGuard<decltype(lock)> guard(lock);
+
+		Ptr ret = instance.lock();
+		if (!ret) {
+			ret = Ptr(new WorkerPool());
+			instance = ret;
+		}
+
+		return ret;
+	}
+
+private:
+	static void proc(WorkerPool* self) {
+		Platform::threadName("WORKER");
+
+		Platform::locale("C");
+
+		for (; ; ) {
+			Worker* worker = nullptr;
+			do {
+				std::unique_lock<decltype(self->_lock)> guard(self->_lock);
+
+				self->_signal.wait(guard, [self] (void) -> bool { return self->_stopping || !self->_queue.empty(); });
+				if (self->_stopping)
+					return;
+
+				worker = self->_queue.front();
+				self->_queue.pop_front();
+				worker->_scheduled = false;
+				worker->_running = true;
+			} while (false);
+
+			worker->process();
+
+			do {
+				LockGuard<decltype(self->_lock)> guard(self->_lock);
+
+				worker->_running = false;
+				if (!worker->_terminated && worker->hasMessage()) {
+					worker->_scheduled = true;
+					self->_queue.push_back(worker);
+				}
+			} while (false);
+			self->_idle.notify_all();
+		}
+	}
+};
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+Worker::Worker(ScriptingLua* impl, const std::string &name, const std::string &source) :
+	_impl(impl),
+	_name(name),
+	_source(source),
+	_terminated(false)
+{
+#if BITTY_MULTITHREAD_ENABLED
+	_pool = WorkerPool::acquire();
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+	_L = Lua::create(
+		[] (void* /* userdata */, void* ptr, size_t /* oldSize */, size_t newSize) -> void* {
+			if (newSize == 0) {
+				free(ptr);
+
+				return nullptr;
+			} else {
+				return realloc(ptr, newSize);
+			}
+		},
+		_impl // For the functions which use `ScriptingLua::instanceOf(...)`, only thread-safe members are accessed.
+	);
+	*(Worker**)lua_getextraspace(_L) = this;
+
+	Lua::Standard::worker(_L);
+	Lua::Libs::worker(_L);
+	Lua::reg(
+		_L,
+		Lua::array(
+			luaL_Reg{ "post", emit },
+			luaL_Reg{ nullptr, nullptr }
+		)
+	);
+	assert(Lua::getTop(_L) == 0 && "Polluted Lua stack.");
+
+	Lua::setHook(_L, hook, LUA_MASKCOUNT, SCRIPTING_LUA_WORKER_HOOK_INSTRUCTION_COUNT);
+}
+
+Worker::~Worker() {
+	terminate();
+
+	_pending.clear();
+	_settled.clear();
+	_rcvHandler = nullptr;
+
+	if (_L) {
+		Lua::destroy(_L);
+		_L = nullptr;
+	}
+
+#if BITTY_MULTITHREAD_ENABLED
+	_pool = nullptr;
+#endif /* BITTY_MULTITHREAD_ENABLED */
+}
+
+const std::string &Worker::name(void) const {
+	return _name;
+}
+
+int Worker::pending(void) const {
+	return (int)_pending.size();
+}
+
+bool Worker::terminated(void) const {
+	return _terminated;
+}
+
+bool Worker::post(const Variant &msg, Promise::Ptr promise) {
+	if (_terminated)
+		return false;
+
+	if (++_seed == 0)
+		++_seed;
+	_pending[_seed] = promise;
+
+	do {
+		LockGuard<decltype(_inboxLock)> guard(_inboxLock);
+
+		_inbox.push_back(Message(_seed, msg, true));
+	} while (false);
+
+#if BITTY_MULTITHREAD_ENABLED
+	_pool->schedule(this);
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+	return true;
+}
+
+void Worker::terminate(void) {
+	if (_terminated)
+		return;
+
+	_terminated = true;
+
+#if BITTY_MULTITHREAD_ENABLED
+	_pool->unschedule(this);
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+	do {
+		LockGuard<decltype(_inboxLock)> guard(_inboxLock);
+
+		_inbox.clear();
+	} while (false);
+	do {
+		LockGuard<decltype(_outboxLock)> guard(_outboxLock);
+
+		_outbox.clear();
+	} while (false);
+
+	for (Pending::value_type &kv : _pending) {
+		kv.second->reject("Worker terminated.");
+		_settled.push_back(kv.second);
+	}
+	_pending.clear();
+}
+
+bool Worker::update(double) {
+	// Settled promises are kept for one more cycle, so that their handlers get
+	// invoked before they could be released.
+	_settled.clear();
+
+#if !BITTY_MULTITHREAD_ENABLED
+	if (!_terminated)
+		process();
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+	Messages outbox;
+	do {
+		LockGuard<decltype(_outboxLock)> guard(_outboxLock);
+
+		std::swap(outbox, _outbox);
+	} while (false);
+
+	for (const Message &msg : outbox) {
+		if (msg.id == 0) {
+			if (!_rcvHandler.empty())
+				_rcvHandler(&_rcvHandler, msg.data);
+
+			continue;
+		}
+
+		Pending::iterator it = _pending.find(msg.id);
+		if (it == _pending.end())
+			continue;
+
+		Promise::Ptr promise = it->second;
+		_pending.erase(it);
+		if (msg.ok)
+			promise->resolve(msg.data);
+		else
+			promise->reject(msg.data);
+		_settled.push_back(promise);
+	}
+
+	return true;
+}
+
+void Worker::callback(const ReceivedHandler &cb) {
+	_rcvHandler = cb;
+}
+
+void Worker::readMessage(lua_State* L, Lua::Index idx, bool transfer, Variant &ret) {
+	ret = nullptr;
+
+	if (Lua::isUserdata(L, idx)) {
+		Bytes::Ptr* bytes = nullptr;
+		Lua::read(L, bytes, idx);
+		if (bytes && *bytes) {
+			if (transfer && unique(*bytes)) {
+				ret = Variant(*bytes);
+				*bytes = Bytes::Ptr(Bytes::create());
+			} else {
+				Bytes::Ptr val(Bytes::create());
+				val->writeBytes(bytes->get());
+				val->poke(bytes->get()->peek());
+				ret = Variant(val);
+			}
+
+			return;
+		}
+
+		Json::Ptr* json = nullptr;
+		Lua::read(L, json, idx);
+		if (json && *json) {
+			Json::Ptr val(Json::create());
+			rapidjson::Document doc;
+			(*json)->toJson(doc);
+			val->fromJson(doc);
+			ret = Variant(val);
+
+			return;
+		}
+	}
+
+	Lua::read(L, &ret, idx);
+	if (ret.type() == Variant::OBJECT && !(Object::Ptr)ret)
+		ret = nullptr; // Unsupported userdata.
+}
+
+int Worker::writeMessage(lua_State* L, const Variant &val) {
+	if (val.type() == Variant::OBJECT) {
+		Object::Ptr obj = (Object::Ptr)val;
+
+		if (obj && Object::is<Bytes::Ptr>(obj)) {
+			Bytes::Ptr bytes = Object::as<Bytes::Ptr>(obj);
+
+			return Lua::write(L, &bytes);
+		}
+		if (obj && Object::is<Json::Ptr>(obj)) {
+			Json::Ptr json = Object::as<Json::Ptr>(obj);
+
+			return Lua::write(L, &json);
+		}
+	}
+
+	return Lua::write(L, &val);
+}
+
+bool Worker::load(void) {
+	const std::string entry = "=" + _name;
+	int code = luaL_loadbuffer(_L, _source.c_str(), _source.size(), entry.c_str());
+	if (code == LUA_OK)
+		code = Lua::invoke(_L, 0, 0);
+	_source.clear();
+	_source.shrink_to_fit();
+	if (code != LUA_OK) {
+		Lua::read(_L, _error, Lua::Index(-1));
+		Lua::end(_L);
+		if (_error.empty())
+			_error = "Unknown error.";
+		_impl->observer()->error(_error.c_str());
+
+		return false;
+	}
+
+	const int y = Lua::function(_L, SCRIPTING_LUA_WORKER_FUNCTION_NAME);
+	Lua::end(_L);
+	if (y != LUA_TFUNCTION) {
+		_error = Text::cformat("Cannot find the \"" SCRIPTING_LUA_WORKER_FUNCTION_NAME "\" function in worker: \"%s\".", _name.c_str());
+		_impl->observer()->error(_error.c_str());
+
+		return false;
+	}
+
+	return true;
+}
+
+void Worker::process(void) {
+	if (!_loaded) {
+		_loaded = true;
+
+		load();
+	}
+
+	for (; ; ) {
+		if (_terminated)
+			break;
+
+		Message msg;
+		do {
+			LockGuard<decltype(_inboxLock)> guard(_inboxLock);
+
+			if (_inbox.empty())
+				return;
+
+			msg = _inbox.front();
+			_inbox.pop_front();
+		} while (false);
+
+		if (!_error.empty()) {
+			respond(msg.id, _error, false);
+
+			continue;
+		}
+
+		Lua::function(_L, SCRIPTING_LUA_WORKER_FUNCTION_NAME);
+		writeMessage(_L, msg.data);
+		const int code = Lua::invoke(_L, 1, 1);
+		if (code == LUA_OK) {
+			Variant ret = nullptr;
+			readMessage(_L, Lua::Index(-1), false, ret);
+			Lua::end(_L);
+
+			respond(msg.id, ret, true);
+		} else {
+			std::string err;
+			Lua::read(_L, err, Lua::Index(-1));
+			Lua::end(_L);
+			if (err.empty())
+				err = "Unknown error.";
+
+			respond(msg.id, err, false);
+		}
+	}
+}
+
+bool Worker::hasMessage(void) {
+	LockGuard<decltype(_inboxLock)> guard(_inboxLock);
+
+	return !_inbox.empty();
+}
+
+void Worker::respond(UInt32 id, const Variant &data, bool ok) {
+	LockGuard<decltype(_outboxLock)> guard(_outboxLock);
+
+	_outbox.push_back(Message(id, data, ok));
+}
+
+Worker* Worker::instanceOf(lua_State* L) {
+	return *(Worker**)lua_getextraspace(L);
+}
+
+int Worker::emit(lua_State* L) {
+	Worker* self = instanceOf(L);
+
+	const int n = Lua::getTop(L);
+	bool transfer = false;
+	if (n >= 2)
+		Lua::read<2>(L, transfer);
+
+	Variant msg = nullptr;
+	readMessage(L, Lua::Index(1), transfer, msg);
+
+	self->respond(0, msg, true);
+
+	return 0;
+}
+
+void Worker::hook(lua_State* L, lua_Debug*) {
+	Worker* self = instanceOf(L);
+	if (!self->_terminated)
+		return;
+
+	Lua::setHook(L, nullptr, LUA_MASKCOUNT, 0); // Cancel the current hook.
+
+	Lua::error(L, "Worker terminated.");
+}
+
+namespace Lua {
+
+LUA_CHECK_OBJ(Worker)
+LUA_READ_OBJ(Worker)
+LUA_WRITE_OBJ(Worker)
+LUA_WRITE_OBJ_CONST(Worker)
+
+}
+
+/* ===========================================================================} */
+
 /*
 ** {===========================================================================
 ** Standard
@@ -1076,6 +1669,9 @@ static int fetch(lua_State* L) {
 	std::string url;
 	read<>(L, url);
 	Variant options = nullptr;
+	std::string outputPath;
+	Bytes::Ptr outputBytes = nullptr;
+	Function::Ptr progress = nullptr;
 	if (n >= 2) {
 		if (isUserdata(L, 2)) {
 			Json::Ptr* json = nullptr;
@@ -1085,6 +1681,19 @@ static int fetch(lua_State* L) {
 				(*json)->toAny(options);
 		} else if (isTable(L, 2)) {
 			read<2>(L, &options);
+
+			lua_pushvalue(L, 2); // Before: ...; after: ...table (top).
+			getTable(L, "output"); // Before: ...table (top); after: ...output, table (top).
+			if (isString(L, -2)) {
+				read(L, outputPath, Index(-2));
+			} else if (isUserdata(L, -2)) {
+				Bytes::Ptr* bytes = nullptr;
+				read(L, bytes, Index(-2));
+				if (bytes)
+					outputBytes = *bytes;
+			}
+			getTable(L, "progress", progress); // Before: ...output, table (top); after: ...output, table (top).
+			pop(L, 2); // Before: ...output, table (top); after: ... (top).
 		}
 	}
 
@@ -1120,38 +1729,44 @@ static int fetch(lua_State* L) {
 		Fetch::RespondedHandler(
 			Fetch::RespondedHandler::Callback(
 				std::bind(
-					[] (Promise::WeakPtr promise, Fetch* web, Fetch::RespondedHandler* self, const Byte* buf, size_t len) -> void {
+					[] (Promise::WeakPtr promise, Fetch* web, std::string outputPath, Bytes::Ptr outputBytes, Fetch::RespondedHandler* self, const Byte* buf, size_t len) -> void {
 						Variant rsp = nullptr;
 						const Fetch::DataTypes type = web->dataType();
-						switch (type) {
-						case Fetch::BYTES: {
-								std::string str;
-								str.assign((const char*)buf, len);
-								Bytes::Ptr bytes(Bytes::create());
-								bytes->writeString(str);
-								rsp = Variant(bytes);
-							}
-
-							break;
-						case Fetch::JSON: {
-								std::string str;
-								str.assign((const char*)buf, len);
-								Json::Ptr json(Json::create());
-								if (json->fromString(str))
-									rsp = Variant(json);
-								else
+						if (!outputPath.empty())
+							rsp = Variant(outputPath); // Streamed to file.
+						else if (outputBytes)
+							rsp = Variant(outputBytes); // Streamed to bytes.
+						else {
+							switch (type) {
+							case Fetch::BYTES: {
+									std::string str;
+									str.assign((const char*)buf, len);
+									Bytes::Ptr bytes(Bytes::create());
+									bytes->writeString(str);
+									rsp = Variant(bytes);
+								}
+
+								break;
+							case Fetch::JSON: {
+									std::string str;
+									str.assign((const char*)buf, len);
+									Json::Ptr json(Json::create());
+									if (json->fromString(str))
+										rsp = Variant(json);
+									else
+										rsp = Variant(str);
+								}
+
+								break;
+							case Fetch::STRING: // Fall through.
+							default: {
+									std::string str;
+									str.assign((const char*)buf, len);
 									rsp = Variant(str);
-							}
+								}
 
-							break;
-						case Fetch::STRING: // Fall through.
-						default: {
-								std::string str;
-								str.assign((const char*)buf, len);
-								rsp = Variant(str);
+								break;
 							}
-
-							break;
 						}
 						if (!promise.expired()) {
 							Promise::Ptr ptr = promise.lock();
@@ -1162,8 +1777,9 @@ static int fetch(lua_State* L) {
 
 						web->callback(Fetch::RespondedHandler());
 						web->callback(Fetch::ErrorHandler());
+						web->callback(Fetch::ProgressHandler());
 					},
-					Promise::WeakPtr(ret), web.get(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3
+					Promise::WeakPtr(ret), web.get(), outputPath, outputBytes, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3
 				)
 			)
 		)
@@ -1182,15 +1798,46 @@ static int fetch(lua_State* L) {
 
 						web->callback(Fetch::RespondedHandler());
 						web->callback(Fetch::ErrorHandler());
+						web->callback(Fetch::ProgressHandler());
 					},
 					Promise::WeakPtr(ret), web.get(), std::placeholders::_1, std::placeholders::_2
 				)
 			)
 		)
 	);
+	if (progress) {
+		Fetch::ProgressHandler::Callback func = std::bind(
+			[] (lua_State* L, Fetch::ProgressHandler* self, long long received, long long total) -> bool {
+				Function::Ptr* ptr = (Function::Ptr*)self->userdata().get();
+
+				const Variant argv[] = {
+					Variant((Variant::Real)received),
+					Variant((Variant::Real)total)
+				};
+				Variant ret = nullptr;
+				ScriptingLua::check(L, call(&ret, L, **ptr, 2, argv));
+
+				return !(ret.type() == Variant::BOOLEAN && !(bool)ret); // Returns `false` to cancel.
+			},
+			L, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3
+		);
+		Any ud(
+			new Function::Ptr(progress),
+			[] (void* ptr) -> void {
+				Function::Ptr* func = (Function::Ptr*)ptr;
+				delete func;
+			}
+		);
+		web->callback(Fetch::ProgressHandler(func, ud));
+	}
 	web->url(url.c_str());
 	web->options(options);
-	web->perform();
+	if (!outputPath.empty())
+		web->output(outputPath.c_str());
+	else if (outputBytes)
+		web->output(outputBytes);
+	if (!web->perform())
+		ret->reject("Cannot perform fetch.");
 
 	return write(L, &ret);
 }
@@ -1213,6 +1860,190 @@ static void open_Web(lua_State*) {
 
 #endif /* BITTY_WEB_ENABLED */
 
+/**< Worker. */
+
+static int Worker_ctor(lua_State* L) {
+	ScriptingLua* impl = ScriptingLua::instanceOf(L);
+
+	const int n = getTop(L);
+	const char* path = nullptr;
+	Function::Ptr recv = nullptr;
+	if (n >= 2)
+		read<>(L, path, recv);
+	else
+		read<>(L, path);
+
+	if (!path) {
+		error(L, "Source code path expected.");
+
+		return 0;
+	}
+
+	std::string full = path;
+	if (!Text::endsWith(full, "." BITTY_LUA_EXT, true))
+		full += "." BITTY_LUA_EXT;
+
+	std::string src;
+	do {
+		LockGuard<RecursiveMutex>::UniquePtr acquired;
+		Project* prj = impl->project()->acquire(acquired);
+		if (!prj)
+			break;
+
+		Asset* asset = prj->get(full.c_str());
+		if (!asset)
+			break;
+
+		asset->prepare(Asset::RUNNING, true);
+		Object::Ptr obj = asset->object(Asset::RUNNING);
+		Code::Ptr code = obj ? Object::as<Code::Ptr>(obj) : nullptr;
+		size_t len = 0;
+		const char* txt = code ? code->text(&len) : nullptr;
+		if (txt && len)
+			src.assign(txt, len);
+		txt = nullptr;
+		code = nullptr;
+		obj = nullptr;
+		asset->finish(Asset::RUNNING, true);
+	} while (false);
+
+	if (src.empty()) {
+		const std::string msg = Text::cformat("Cannot find worker source code: \"%s\".", full.c_str());
+		error(L, msg.c_str());
+
+		return 0;
+	}
+
+	Worker::Ptr obj(
+		new Worker(impl, full, src),
+		[impl] (Worker* worker) -> void {
+			impl->removeUpdatable(worker);
+
+			worker->terminate();
+
+			delete worker;
+		}
+	);
+	if (!obj)
+		return write(L, nullptr);
+
+	if (recv) {
+		Worker::ReceivedHandler::Callback func = std::bind(
+			[] (lua_State* L, Worker::ReceivedHandler* self, const Variant &msg) -> void {
+				Function::Ptr* ptr = (Function::Ptr*)self->userdata().get();
+
+				Standard::Promise_call(L, ptr, msg);
+			},
+			L, std::placeholders::_1, std::placeholders::_2
+		);
+		Any ud(
+			new Function::Ptr(recv),
+			[] (void* ptr) -> void {
+				Function::Ptr* func = (Function::Ptr*)ptr;
+				delete func;
+			}
+		);
+		Worker::ReceivedHandler cb(func, ud);
+
+		obj->callback(cb);
+	}
+
+	impl->addUpdatable(obj.get());
+
+	return write(L, &obj);
+}
+
+static int Worker_post(lua_State* L) {
+	const int n = getTop(L);
+	Worker::Ptr* obj = nullptr;
+	bool transfer = false;
+	if (n >= 3)
+		read<3>(L, transfer);
+	read<>(L, obj);
+
+	if (!obj)
+		return 0;
+
+	Variant msg = nullptr;
+	Worker::readMessage(L, Index(2), transfer, msg);
+
+	Promise::Ptr promise = nullptr;
+	const int result = Standard::Promise_ctor(L, promise, true);
+	if (promise && !obj->get()->post(msg, promise))
+		promise->reject("Worker terminated.");
+
+	return result;
+}
+
+static int Worker_terminate(lua_State* L) {
+	Worker::Ptr* obj = nullptr;
+	read<>(L, obj);
+
+	if (obj)
+		obj->get()->terminate();
+
+	return 0;
+}
+
+static int Worker___index(lua_State* L) {
+	Worker::Ptr* obj = nullptr;
+	const char* field = nullptr;
+	read<>(L, obj, field);
+
+	if (!obj || !field)
+		return 0;
+
+	if (strcmp(field, "name") == 0) {
+		const std::string &ret = obj->get()->name();
+
+		return write(L, ret);
+	} else if (strcmp(field, "pending") == 0) {
+		const int ret = obj->get()->pending();
+
+		return write(L, ret);
+	} else if (strcmp(field, "terminated") == 0) {
+		const bool ret = obj->get()->terminated();
+
+		return write(L, ret);
+	} else {
+		return __index(L, field);
+	}
+}
+
+static int Worker___newindex(lua_State* L) {
+	Worker::Ptr* obj = nullptr;
+	const char* field = nullptr;
+	read<>(L, obj, field);
+
+	if (!obj || !field)
+		return 0;
+
+	return 0;
+}
+
+static void open_Worker(lua_State* L) {
+	def(
+		L, "Worker",
+		LUA_LIB(
+			array(
+				luaL_Reg{ "new", Worker_ctor },
+				luaL_Reg{ nullptr, nullptr }
+			)
+		),
+		array(
+			luaL_Reg{ "__gc", __gc<Worker::Ptr> },
+			luaL_Reg{ "__tostring", __tostring<Worker::Ptr> },
+			luaL_Reg{ nullptr, nullptr }
+		),
+		array(
+			luaL_Reg{ "post", Worker_post }, // Asynchronized.
+			luaL_Reg{ "terminate", Worker_terminate },
+			luaL_Reg{ nullptr, nullptr }
+		),
+		Worker___index, Worker___newindex
+	);
+}
+
 /**< Categories. */
 
 void promise(class Executable* exec) {
@@ -1224,6 +2055,9 @@ void promise(class Executable* exec) {
 
 	// Web.
 	open_Web(L);
+
+	// Worker.
+	open_Worker(L);
 }
 
 }
@@ -153,6 +153,7 @@ bool Theme::open(class Renderer* rnd) {
 	generic_None("<None>");
 	generic_Ok("Ok");
 	generic_Open("Open");
+	generic_Packed("Packed");
 	generic_Ready("Ready");
 	generic_Reinstall("Reinstall");
 	generic_Revert("Revert");
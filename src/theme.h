@@ -83,6 +83,7 @@ public:
 	BITTY_PROPERTY_READONLY(std::string, generic_None)
 	BITTY_PROPERTY_READONLY(std::string, generic_Ok)
 	BITTY_PROPERTY_READONLY(std::string, generic_Open)
+	BITTY_PROPERTY_READONLY(std::string, generic_Packed)
 	BITTY_PROPERTY_READONLY(std::string, generic_Ready)
 	BITTY_PROPERTY_READONLY(std::string, generic_Reinstall)
 	BITTY_PROPERTY_READONLY(std::string, generic_Revert)
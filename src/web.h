@@ -42,6 +42,13 @@ public:
 	struct ErrorHandler : public Handler<ErrorHandler, void, ErrorHandler*, const char*> {
 		using Handler::Handler;
 	};
+	/**
+	 * @brief Invoked with received and total (0 for unknown) byte counts;
+	 *   returns `false` to cancel the transfer.
+	 */
+	struct ProgressHandler : public Handler<ProgressHandler, bool, ProgressHandler*, long long, long long> {
+		using Handler::Handler;
+	};
 
 public:
 	BITTY_CLASS_TYPE('F', 'E', 'C', 'H')
@@ -58,6 +65,17 @@ public:
 	virtual void method(const char* method /* nullable */) = 0;
 	virtual void body(const char* body /* nullable */) = 0;
 	virtual void timeout(long t, long conn) = 0;
+	/**
+	 * @brief Streams the response body to the specific file instead of memory;
+	 *   the responded callback then receives no data but the total size.
+	 */
+	virtual void output(const char* path /* nullable */) = 0;
+	/**
+	 * @brief Streams the response body into the specific `Bytes` during
+	 *   updating; the responded callback then receives no data but the total
+	 *   size.
+	 */
+	virtual void output(const std::shared_ptr<class Bytes> &bytes /* nullable */) = 0;
 
 	virtual bool perform(void) = 0;
 
@@ -65,8 +83,10 @@ public:
 
 	virtual const RespondedHandler &respondedCallback(void) const = 0;
 	virtual const ErrorHandler &errorCallback(void) const = 0;
+	virtual const ProgressHandler &progressCallback(void) const = 0;
 	virtual void callback(const RespondedHandler &cb /* nullable */) = 0;
 	virtual void callback(const ErrorHandler &cb /* nullable */) = 0;
+	virtual void callback(const ProgressHandler &cb /* nullable */) = 0;
 
 	static Fetch* create(void);
 	static void destroy(Fetch* ptr);
@@ -104,6 +124,10 @@ public:
 
 	virtual bool polling(void) const = 0;
 
+	/**
+	 * @brief Dispatches queued requests to the requested callback on the calling
+	 *   thread; waits up to `timeoutMs` if none is queued.
+	 */
 	virtual void poll(int timeoutMs) = 0;
 
 	virtual bool respond(unsigned code) = 0;
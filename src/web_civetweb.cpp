@@ -9,16 +9,24 @@
 */
 
 #include "bytes.h"
+#include "encoding.h"
+#include "filesystem.h"
 #include "json.h"
 #include "text.h"
 #include "web_civetweb.h"
 #include "../lib/civetweb/include/civetweb.h"
+#include "../lib/zlib/zlib.h"
+#include <sys/stat.h>
 
 /*
 ** {===========================================================================
 ** Macros and constants
 */
 
+#ifndef S_ISDIR
+#	define S_ISDIR(M) (((M) & S_IFMT) == S_IFDIR)
+#endif /* S_ISDIR */
+
 #if BITTY_WEB_ENABLED
 
 #ifndef WEB_STATE
@@ -44,6 +52,103 @@ static void webGetGmtTimeString(char* buf, size_t bufLen, time_t* t) {
 	strftime(buf, bufLen, "%a, %d %b %Y %H:%M:%S GMT", gmtime(t));
 }
 
+/**
+ * @brief Parses an IMF-fixdate, eg. "Sun, 06 Nov 1994 08:49:37 GMT".
+ */
+static bool webParseGmtTimeString(const char* buf, long long* t) {
+	constexpr const char* const MONTHS[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+	char wday[4] = { '\0' };
+	char mon[4] = { '\0' };
+	int d = 0, y = 0, hh = 0, mm = 0, ss = 0;
+	if (sscanf(buf, "%3s, %d %3s %d %d:%d:%d GMT", wday, &d, mon, &y, &hh, &mm, &ss) != 7)
+		return false;
+	int m = 0;
+	while (m < 12 && strcmp(MONTHS[m], mon) != 0)
+		++m;
+	if (m == 12)
+		return false;
+
+	// Days since the epoch of the civil date.
+	++m;
+	y -= m <= 2 ? 1 : 0;
+	const long long era = (y >= 0 ? y : y - 399) / 400;
+	const long long yoe = y - era * 400;
+	const long long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	const long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	const long long days = era * 146097 + doe - 719468;
+	*t = days * 86400 + hh * 3600 + mm * 60 + ss;
+
+	return true;
+}
+
+/**
+ * @brief Checks whether an "If-None-Match" list matches the specific entity
+ *   tag, with the weak comparison.
+ */
+static bool webMatchesEtag(const char* ifNoneMatch, const std::string &etag) {
+	auto opaque = [] (const std::string &tag) -> std::string {
+		return Text::startsWith(tag, "W/", false) ? tag.substr(2) : tag;
+	};
+
+	const std::string self = opaque(etag);
+	const Text::Array tags = Text::split(ifNoneMatch, ",");
+	for (const std::string &tag : tags) {
+		const std::string tag_ = Text::trim(tag);
+		if (tag_ == "*" || opaque(tag_) == self)
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * @param[in] windowBits 15 + 16 for "gzip", 15 for "deflate" (zlib format).
+ */
+static bool webCompress(const std::string &src, std::string &dst, int windowBits) {
+	dst.clear();
+
+	z_stream strm;
+	memset(&strm, 0, sizeof(z_stream));
+	if (deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	dst.resize(deflateBound(&strm, (uLong)src.length()) + 32);
+	strm.next_in = (Bytef*)src.c_str();
+	strm.avail_in = (uInt)src.length();
+	strm.next_out = (Bytef*)&dst.front();
+	strm.avail_out = (uInt)dst.length();
+	const int ret = deflate(&strm, Z_FINISH);
+	const uLong len = strm.total_out;
+	deflateEnd(&strm);
+	if (ret != Z_STREAM_END) {
+		dst.clear();
+
+		return false;
+	}
+	dst.resize((size_t)len);
+
+	return true;
+}
+
+static bool webAccepts(const char* acceptEncoding, const char* coding) {
+	if (!acceptEncoding)
+		return false;
+
+	const Text::Array codings = Text::split(acceptEncoding, ",");
+	for (const std::string &c : codings) {
+		const Text::Array parts = Text::split(c, ";");
+		if (parts.empty() || Text::trim(parts.front()) != coding)
+			continue;
+		if (parts.size() >= 2 && Text::trim(parts[1]) == "q=0")
+			return false;
+
+		return true;
+	}
+
+	return false;
+}
+
 static int webEventHandler(struct mg_connection* nc, void* cbdata) {
 	struct mg_context* ctx = mg_get_context(nc);
 	WebCivetWeb* web = (WebCivetWeb*)mg_get_user_data(ctx);
@@ -132,8 +237,6 @@ bool WebCivetWeb::close(void) {
 		_rspdHandler.clear();
 	} while (false);
 
-	_pollingConn = nullptr;
-
 	// Clear options.
 	_root.clear();
 
@@ -158,19 +261,17 @@ bool WebCivetWeb::polling(void) const {
 }
 
 void WebCivetWeb::poll(int timeoutMs) {
-	(void)timeoutMs;
-
 	if (!_opened && !_shutting)
 		return;
 
-	doPoll();
+	doPoll(timeoutMs);
 }
 
 bool WebCivetWeb::update(double) {
 	if (!ready())
 		return true;
 
-	doPoll();
+	doPoll(0);
 
 	if (_shutting)
 		close();
@@ -179,205 +280,58 @@ bool WebCivetWeb::update(double) {
 }
 
 bool WebCivetWeb::respond(unsigned code) {
-	struct mg_connection* conn = _pollingConn; // Using it.
-	switch (code) {
-	case 400:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 400 Bad Request\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
-
-		break;
-	case 401:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 401 Unauthorized\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
-
-		break;
-	case 403:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 403 Forbidden\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
-
-		break;
-	case 405:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 405 Method Not Allowed\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
-
-		break;
-	case 406:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 406 Not Acceptable\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
-
-		break;
-	case 414:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 414 URI Too Long\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
-
-		break;
-	case 415:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 415 Unsupported Media Type\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
-
-		break;
-	case 500:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 500 Internal Server Error\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
-
-		break;
-	case 501:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 501 Not Implemented\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
-
-		break;
-	case 503:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 503 Service Unavailable\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
-
-		break;
-	case 505:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 505 HTTP Version Not Supported\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
-
-		break;
-	case 404: // Fall through.
-	default:
-		mg_printf(
-			conn, "%s",
-			"HTTP/1.0 404 Not Found\r\n"
-			"Content-Length: 0\r\n\r\n"
-		);
+	Request::Ptr req = _current; // Answering it.
+	if (!req)
+		return false;
 
-		break;
-	}
+	req->code = code;
+	req->mimeType.clear();
+	req->content.clear();
 
 	return true;
 }
 
-bool WebCivetWeb::respond(const char* data, const char* mimeType_) {
+bool WebCivetWeb::respond(const char* data, const char* mimeType) {
 	if (!data || !*data)
 		return false;
 
-	struct mg_connection* conn = _pollingConn; // Using it.
-
-	const std::string mimeType = mimeType_ ? mimeType_ : "text/plain";
-	char currentTime[50];
-	time_t t;
-	time(&t);
-	webGetGmtTimeString(currentTime, sizeof(currentTime), &t);
-	const size_t len = strlen(data);
-
-	mg_printf(
-		conn,
-		"HTTP/1.1 200 OK\r\n"
-		"Cache: no-cache\r\n"
-		"Date: %s\r\n"
-		"Accept-Ranges: bytes\r\n"
-		"Connection: close\r\n"
-		"Content-Type: %s\r\n"
-		"Content-Length: %zu\r\n",
-		currentTime,
-		mimeType.c_str(),
-		len
-	);
-	mg_write(conn, "\r\n", 2);
-	mg_write(conn, data, (int)len);
-	mg_write(conn, "\r\n", 2);
+	Request::Ptr req = _current; // Answering it.
+	if (!req)
+		return false;
+
+	req->code = 200;
+	req->mimeType = mimeType ? mimeType : "text/plain";
+	req->content = data;
 
 	return true;
 }
 
-bool WebCivetWeb::respond(const class Json* data, const char* mimeType_) {
+bool WebCivetWeb::respond(const class Json* data, const char* mimeType) {
 	if (!data)
 		return false;
 
-	struct mg_connection* conn = _pollingConn; // Using it.
-
-	const std::string mimeType = mimeType_ ? mimeType_ : "application/json";
-	char currentTime[50];
-	time_t t;
-	time(&t);
-	webGetGmtTimeString(currentTime, sizeof(currentTime), &t);
-	std::string content;
-	data->toString(content, false);
-
-	mg_printf(
-		conn,
-		"HTTP/1.1 200 OK\r\n"
-		"Cache: no-cache\r\n"
-		"Date: %s\r\n"
-		"Accept-Ranges: bytes\r\n"
-		"Connection: close\r\n"
-		"Content-Type: %s\r\n"
-		"Content-Length: %zu\r\n",
-		currentTime,
-		mimeType.c_str(),
-		content.length()
-	);
-	mg_write(conn, "\r\n", 2);
-	mg_write(conn, content.c_str(), (int)content.length());
-	mg_write(conn, "\r\n", 2);
+	Request::Ptr req = _current; // Answering it.
+	if (!req)
+		return false;
+
+	req->code = 200;
+	req->mimeType = mimeType ? mimeType : "application/json";
+	data->toString(req->content, false);
 
 	return true;
 }
 
-bool WebCivetWeb::respond(const class Bytes* data, const char* mimeType_) {
+bool WebCivetWeb::respond(const class Bytes* data, const char* mimeType) {
 	if (!data)
 		return false;
 
-	struct mg_connection* conn = _pollingConn; // Using it.
-
-	const std::string mimeType = mimeType_ ? mimeType_ : "application/octet-stream";
-	char currentTime[50];
-	time_t t;
-	time(&t);
-	webGetGmtTimeString(currentTime, sizeof(currentTime), &t);
-
-	mg_printf(
-		conn,
-		"HTTP/1.1 200 OK\r\n"
-		"Cache: no-cache\r\n"
-		"Date: %s\r\n"
-		"Accept-Ranges: bytes\r\n"
-		"Connection: close\r\n"
-		"Content-Type: %s\r\n"
-		"Content-Length: %zu\r\n",
-		currentTime,
-		mimeType.c_str(),
-		data->count()
-	);
-	mg_write(conn, "\r\n", 2);
-	mg_write(conn, (const char*)data->pointer(), (int)data->count());
-	mg_write(conn, "\r\n", 2);
+	Request::Ptr req = _current; // Answering it.
+	if (!req)
+		return false;
+
+	req->code = 200;
+	req->mimeType = mimeType ? mimeType : "application/octet-stream";
+	req->content.assign((const char*)data->pointer(), data->count());
 
 	return true;
 }
@@ -405,11 +359,14 @@ void WebCivetWeb::doOpen(unsigned short port) {
 	if (timeoutstr.empty())
 		timeoutstr = "10000";
 
+	const std::string threadsstr = Text::toString((Int32)WEB_CIVETWEB_THREAD_COUNT);
+
 	const char* options[] = {
 		"document_root",            _root.c_str(),
 		"enable_directory_listing", "yes",
+		"enable_keep_alive",        "yes",
 		"listening_ports",          portstr.c_str(),
-		"num_threads",              "1",
+		"num_threads",              threadsstr.c_str(),
 		"request_timeout_ms",       timeoutstr.c_str(),
 		0
 	};
@@ -425,13 +382,69 @@ void WebCivetWeb::doOpen(unsigned short port) {
 }
 
 void WebCivetWeb::doClose(void) {
+	// Release the server threads which are waiting for answers, so that
+	// stopping does not block until they time out.
+	do {
+		std::unique_lock<std::mutex> guard(_requestsLock);
+
+		for (Request::Ptr &req : _requests)
+			req->state = Request::CANCELED;
+		_requests.clear();
+	} while (false);
+	_respondedCond.notify_all();
+
 	mg_stop(_ctx);
+	_ctx = nullptr;
+
+	std::unique_lock<std::mutex> guard(_staticLock);
+
+	_staticFiles.clear();
+	_staticFileIndex.clear();
+	_staticSize = 0;
 }
 
-void WebCivetWeb::doPoll(void) {
+void WebCivetWeb::doPoll(int timeoutMs) {
 	WEB_STATE(_polling, false, true, return)
 
-	// Do nothing.
+	Requests requests;
+	do {
+		std::unique_lock<std::mutex> guard(_requestsLock);
+
+		if (_requests.empty() && timeoutMs > 0) {
+			_requestsCond.wait_for(
+				guard,
+				std::chrono::milliseconds(timeoutMs),
+				[&] (void) -> bool {
+					return !_requests.empty();
+				}
+			);
+		}
+		std::swap(requests, _requests);
+	} while (false);
+	if (requests.empty())
+		return;
+
+	RequestedHandler handler = nullptr;
+	do {
+		LockGuard<decltype(_rspdHandlerLock)> guard(_rspdHandlerLock);
+
+		handler = _rspdHandler;
+	} while (false);
+
+	for (Request::Ptr &req : requests) {
+		bool ret = false;
+		if (!handler.empty()) {
+			_current = req;
+			ret = handler(&handler, req->method.c_str(), req->uri.c_str(), req->query.c_str(), req->body.c_str(), req->headers);
+			_current = nullptr;
+		}
+
+		std::unique_lock<std::mutex> guard(_requestsLock);
+
+		if (req->state == Request::PENDING)
+			req->state = ret ? Request::RESPONDED : Request::FALLBACK;
+	}
+	_respondedCond.notify_all();
 }
 
 bool WebCivetWeb::onHttp(struct mg_connection* nc, void* cbdata) {
@@ -440,46 +453,286 @@ bool WebCivetWeb::onHttp(struct mg_connection* nc, void* cbdata) {
 	const struct mg_request_info* ri = mg_get_request_info(nc);
 	const char* url = ri->local_uri;
 
+	bool handled = false;
 	do {
-		if (!ready())
+		LockGuard<decltype(_rspdHandlerLock)> guard(_rspdHandlerLock);
+
+		handled = !_rspdHandler.empty();
+	} while (false);
+	if (!handled) {
+		if (strcmp(ri->request_method, "GET") == 0 || strcmp(ri->request_method, "HEAD") == 0)
+			serve(nc, url);
+		else
+			mg_send_http_error(nc, 405, "%s", "");
+
+		return true;
+	}
+
+	// Read the entire body, either sized by "Content-Length" or chunked.
+	Request::Ptr req(new Request());
+	req->method = ri->request_method ? ri->request_method : "";
+	req->uri = url;
+	req->query = ri->query_string ? ri->query_string : "";
+	if (ri->content_length > 0)
+		req->body.reserve((size_t)std::min(ri->content_length, (long long)WEB_CIVETWEB_MAX_BODY_SIZE));
+	char buf[4096];
+	for (; ; ) {
+		const int n = mg_read(nc, buf, sizeof(buf));
+		if (n <= 0)
 			break;
 
-		WEB_STATE(_pollingConn, nullptr, nc, break)
+		if (req->body.length() + n > WEB_CIVETWEB_MAX_BODY_SIZE) {
+			mg_send_http_error(nc, 413, "%s", "");
 
-		LockGuard<decltype(_rspdHandlerLock)> guard(_rspdHandlerLock);
+			return true;
+		}
+		req->body.append(buf, (size_t)n);
+	}
+	for (int i = 0; i < ri->num_headers; ++i) {
+		const struct mg_header &h = ri->http_headers[i];
+		if (h.name) {
+			req->headers[h.name] = h.value ? h.value : "";
+		}
+	}
 
-		if (requestedCallback().empty()) {
-			if (strcmp(ri->request_method, "GET") == 0) {
-				mg_send_file(nc, url);
-			}
-		} else {
-			const std::string method(ri->request_method ? ri->request_method : "");
-			const std::string uri(url);
-			const std::string query(ri->query_string ? ri->query_string : "");
-
-			char bodybuff[1024];
-			const int bodylen = mg_read(nc, bodybuff, sizeof(bodybuff) - 1);
-			const std::string body(bodybuff, (size_t)bodylen);
-
-			Text::Dictionary headers;
-			for (int i = 0; i < ri->num_headers; ++i) {
-				const struct mg_header &h = ri->http_headers[i];
-				if (h.name) {
-					headers[h.name] = h.value ? h.value : "";
-				}
-			}
+	// Queue it, and wait for the polling thread to answer.
+	do {
+		std::unique_lock<std::mutex> guard(_requestsLock);
+
+		if (!ready()) {
+			req->state = Request::CANCELED;
 
-			RequestedHandler &handler = const_cast<RequestedHandler &>(requestedCallback());
-			const bool ret = handler(&handler, method.c_str(), uri.c_str(), query.c_str(), body.c_str(), headers);
-			if (!ret) {
-				mg_send_file(nc, url);
+			break;
+		}
+
+		_requests.push_back(req);
+		_requestsCond.notify_one();
+		const bool answered = _respondedCond.wait_for(
+			guard,
+			std::chrono::milliseconds(_timeoutMs),
+			[&] (void) -> bool {
+				return req->state != Request::PENDING;
 			}
+		);
+		if (!answered) {
+			Requests::iterator it = std::find(_requests.begin(), _requests.end(), req);
+			if (it != _requests.end())
+				_requests.erase(it);
+			req->state = Request::CANCELED;
 		}
 	} while (false);
 
+	switch (req->state) {
+	case Request::RESPONDED:
+		send(nc, *req);
+
+		break;
+	case Request::FALLBACK:
+		serve(nc, url);
+
+		break;
+	default:
+		mg_send_http_error(nc, 503, "%s", "");
+
+		break;
+	}
+
 	return true;
 }
 
+void WebCivetWeb::send(struct mg_connection* nc, const Request &req) {
+	// Use the response header API, so that "Date" and "Connection" are filled
+	// according to the keep-alive state of the connection.
+	mg_response_header_start(nc, (int)req.code);
+	if (req.content.empty()) {
+		mg_response_header_add(nc, "Content-Length", "0", -1);
+		mg_response_header_send(nc);
+
+		return;
+	}
+
+	mg_response_header_add(nc, "Cache-Control", "no-cache", -1);
+	mg_response_header_add(nc, "Content-Type", req.mimeType.c_str(), -1);
+	const char* data = req.content.c_str();
+	const size_t len = req.content.length();
+	const std::string lenstr = Text::toString((UInt64)len);
+	mg_response_header_add(nc, "Content-Length", lenstr.c_str(), -1); // The whole body is known, works with HTTP/1.0 as well.
+	mg_response_header_send(nc);
+	for (size_t i = 0; i < len; i += WEB_CIVETWEB_CHUNK_SIZE) { // Written in pieces to bound each socket write.
+		const size_t n = std::min(len - i, (size_t)WEB_CIVETWEB_CHUNK_SIZE);
+		if (mg_write(nc, data + i, n) <= 0)
+			return;
+	}
+}
+
+void WebCivetWeb::serve(struct mg_connection* nc, const char* uri) {
+	// Resolve the path under the root directory; leave directories and
+	// anything suspicious to CivetWeb.
+	const std::string uri_ = uri ? uri : "";
+	if (uri_.empty() || uri_.front() != '/' || uri_.back() == '/' || uri_.find("..") != std::string::npos) {
+		mg_send_file(nc, uri);
+
+		return;
+	}
+	const std::string path = Path::combine(_root.c_str(), uri_.c_str() + 1);
+	const std::string osstr = Unicode::toOs(path);
+	struct stat buf;
+	if (stat(osstr.c_str(), &buf) != 0 || S_ISDIR(buf.st_mode) || (size_t)buf.st_size > WEB_CIVETWEB_STATIC_MAX_FILE_SIZE) {
+		mg_send_file(nc, uri);
+
+		return;
+	}
+
+	// Find it in the cache, and invalidate on modification.
+	StaticFile::Ptr file = nullptr;
+	do {
+		std::unique_lock<std::mutex> guard(_staticLock);
+
+		StaticFileIndex::iterator it = _staticFileIndex.find(path);
+		if (it == _staticFileIndex.end())
+			break;
+
+		file = *it->second;
+		if (file->modified != (long long)buf.st_mtime || file->fileSize != (size_t)buf.st_size) {
+			_staticSize -= file->size();
+			_staticFiles.erase(it->second);
+			_staticFileIndex.erase(it);
+			file = nullptr;
+
+			break;
+		}
+		_staticFiles.splice(_staticFiles.begin(), _staticFiles, it->second);
+	} while (false);
+
+	// Load and cache it, least recently used ones are evicted.
+	if (!file) {
+		file = load(path);
+		if (!file) {
+			mg_send_file(nc, uri);
+
+			return;
+		}
+
+		std::unique_lock<std::mutex> guard(_staticLock);
+
+		if (_staticFileIndex.find(path) == _staticFileIndex.end()) { // Not loaded by another thread meanwhile.
+			_staticFiles.push_front(file);
+			_staticFileIndex[path] = _staticFiles.begin();
+			_staticSize += file->size();
+			while (_staticSize > WEB_CIVETWEB_STATIC_CACHE_SIZE && _staticFiles.size() > 1) {
+				StaticFile::Ptr back = _staticFiles.back();
+				_staticSize -= back->size();
+				_staticFileIndex.erase(back->path);
+				_staticFiles.pop_back();
+			}
+		}
+	}
+
+	// Pick a variant.
+	const char* acceptEncoding = mg_get_header(nc, "Accept-Encoding");
+	const std::string* content = &file->content;
+	const char* encoding = nullptr;
+	if (!file->gzip.empty() && webAccepts(acceptEncoding, "gzip")) {
+		content = &file->gzip;
+		encoding = "gzip";
+	} else if (!file->deflate.empty() && webAccepts(acceptEncoding, "deflate")) {
+		content = &file->deflate;
+		encoding = "deflate";
+	}
+	const bool varying = !file->gzip.empty() || !file->deflate.empty();
+
+	// Each variant has its own strong validator.
+	std::string etag = file->etag;
+	if (encoding) {
+		etag.pop_back(); // The closing quote.
+		etag += "-";
+		etag += encoding;
+		etag += "\"";
+	}
+
+	// Answer with "304 Not Modified" if the client has it already,
+	// "If-Modified-Since" is only considered without "If-None-Match".
+	const char* ifNoneMatch = mg_get_header(nc, "If-None-Match");
+	const char* ifModifiedSince = mg_get_header(nc, "If-Modified-Since");
+	bool notModified = false;
+	if (ifNoneMatch) {
+		notModified = webMatchesEtag(ifNoneMatch, etag);
+	} else if (ifModifiedSince) {
+		long long since = 0;
+		notModified = webParseGmtTimeString(ifModifiedSince, &since) && file->modified <= since;
+	}
+	if (notModified) {
+		mg_response_header_start(nc, 304);
+		mg_response_header_add(nc, "ETag", etag.c_str(), -1);
+		mg_response_header_add(nc, "Cache-Control", WEB_CIVETWEB_STATIC_CACHE_CONTROL, -1);
+		if (varying)
+			mg_response_header_add(nc, "Vary", "Accept-Encoding", -1);
+		mg_response_header_send(nc);
+
+		return;
+	}
+
+	const std::string lenstr = Text::toString((UInt64)content->length());
+	mg_response_header_start(nc, 200);
+	mg_response_header_add(nc, "Content-Type", file->mimeType.c_str(), -1);
+	mg_response_header_add(nc, "Content-Length", lenstr.c_str(), -1);
+	mg_response_header_add(nc, "ETag", etag.c_str(), -1);
+	mg_response_header_add(nc, "Last-Modified", file->lastModified.c_str(), -1);
+	mg_response_header_add(nc, "Cache-Control", WEB_CIVETWEB_STATIC_CACHE_CONTROL, -1);
+	if (varying)
+		mg_response_header_add(nc, "Vary", "Accept-Encoding", -1);
+	if (encoding)
+		mg_response_header_add(nc, "Content-Encoding", encoding, -1);
+	mg_response_header_send(nc);
+
+	const struct mg_request_info* ri = mg_get_request_info(nc);
+	if (strcmp(ri->request_method, "HEAD") != 0)
+		mg_write(nc, content->c_str(), content->length());
+}
+
+WebCivetWeb::StaticFile::Ptr WebCivetWeb::load(const std::string &path) {
+	const std::string osstr = Unicode::toOs(path);
+	struct stat buf;
+	if (stat(osstr.c_str(), &buf) != 0)
+		return nullptr;
+
+	FILE* fp = fopen(osstr.c_str(), "rb");
+	if (!fp)
+		return nullptr;
+
+	StaticFile::Ptr file(new StaticFile());
+	file->path = path;
+	file->modified = (long long)buf.st_mtime;
+	file->fileSize = (size_t)buf.st_size;
+	file->content.resize(file->fileSize);
+	const size_t n = file->fileSize ? fread(&file->content.front(), 1, file->fileSize, fp) : 0;
+	fclose(fp);
+	if (n != file->fileSize)
+		return nullptr;
+
+	char etag[64];
+	snprintf(etag, sizeof(etag), "\"%llx-%llx\"", (unsigned long long)file->modified, (unsigned long long)file->fileSize);
+	file->etag = etag;
+	char lastModified[64];
+	time_t t = (time_t)buf.st_mtime;
+	webGetGmtTimeString(lastModified, sizeof(lastModified), &t);
+	file->lastModified = lastModified;
+	file->mimeType = mg_get_builtin_mime_type(path.c_str());
+
+	// Precompress, and keep the variants only if they are noticeably smaller.
+	if (file->fileSize >= WEB_CIVETWEB_STATIC_MIN_COMPRESS_SIZE) {
+		const size_t worth = file->fileSize - file->fileSize / 8;
+		if (!webCompress(file->content, file->gzip, 15 + 16) || file->gzip.length() > worth)
+			file->gzip.clear();
+		if (!file->gzip.empty()) { // Compressible.
+			if (!webCompress(file->content, file->deflate, 15) || file->deflate.length() > worth)
+				file->deflate.clear();
+		}
+	}
+
+	return file;
+}
+
 #endif /* BITTY_WEB_ENABLED */
 
 /* ===========================================================================} */
@@ -12,6 +12,40 @@
 #define __WEB_CIVETWEB_H__
 
 #include "web.h"
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+
+/*
+** {===========================================================================
+** Macros and constants
+*/
+
+#ifndef WEB_CIVETWEB_THREAD_COUNT
+#	define WEB_CIVETWEB_THREAD_COUNT 4
+#endif /* WEB_CIVETWEB_THREAD_COUNT */
+#ifndef WEB_CIVETWEB_CHUNK_SIZE
+#	define WEB_CIVETWEB_CHUNK_SIZE (64 * 1024)
+#endif /* WEB_CIVETWEB_CHUNK_SIZE */
+#ifndef WEB_CIVETWEB_MAX_BODY_SIZE
+#	define WEB_CIVETWEB_MAX_BODY_SIZE (16 * 1024 * 1024)
+#endif /* WEB_CIVETWEB_MAX_BODY_SIZE */
+
+#ifndef WEB_CIVETWEB_STATIC_CACHE_SIZE
+#	define WEB_CIVETWEB_STATIC_CACHE_SIZE (32 * 1024 * 1024)
+#endif /* WEB_CIVETWEB_STATIC_CACHE_SIZE */
+#ifndef WEB_CIVETWEB_STATIC_MAX_FILE_SIZE
+#	define WEB_CIVETWEB_STATIC_MAX_FILE_SIZE (4 * 1024 * 1024)
+#endif /* WEB_CIVETWEB_STATIC_MAX_FILE_SIZE */
+#ifndef WEB_CIVETWEB_STATIC_MIN_COMPRESS_SIZE
+#	define WEB_CIVETWEB_STATIC_MIN_COMPRESS_SIZE 256
+#endif /* WEB_CIVETWEB_STATIC_MIN_COMPRESS_SIZE */
+#ifndef WEB_CIVETWEB_STATIC_CACHE_CONTROL
+#	define WEB_CIVETWEB_STATIC_CACHE_CONTROL "no-cache"
+#endif /* WEB_CIVETWEB_STATIC_CACHE_CONTROL */
+
+/* ===========================================================================} */
 
 /*
 ** {===========================================================================
@@ -21,6 +55,58 @@
 #if BITTY_WEB_ENABLED
 
 class WebCivetWeb : public Web {
+private:
+	/**
+	 * @brief Request received on a server thread, queued until the polling
+	 *   thread answers it, then written back to its own connection.
+	 */
+	struct Request {
+		typedef std::shared_ptr<Request> Ptr;
+
+		enum States {
+			PENDING,
+			RESPONDED,
+			FALLBACK,
+			CANCELED
+		};
+
+		std::string method;
+		std::string uri;
+		std::string query;
+		std::string body;
+		Text::Dictionary headers;
+
+		States state = PENDING;
+		unsigned code = 404;
+		std::string mimeType;
+		std::string content;
+	};
+	typedef std::deque<Request::Ptr> Requests;
+
+	/**
+	 * @brief Static file under the root directory, cached in memory with
+	 *   precompressed variants.
+	 */
+	struct StaticFile {
+		typedef std::shared_ptr<StaticFile> Ptr;
+
+		std::string path;
+		long long modified = 0;
+		size_t fileSize = 0;
+		std::string etag;
+		std::string lastModified;
+		std::string mimeType;
+		std::string content;
+		std::string gzip; // Empty if not worth compressing.
+		std::string deflate; // Ditto.
+
+		size_t size(void) const {
+			return content.length() + gzip.length() + deflate.length();
+		}
+	};
+	typedef std::list<StaticFile::Ptr> StaticFiles;
+	typedef std::map<std::string, StaticFiles::iterator> StaticFileIndex;
+
 private:
 	/**< States. */
 
@@ -39,13 +125,26 @@ private:
 	struct mg_context* _ctx = nullptr;
 	struct mg_callbacks* _callbacks = nullptr;
 
+	/**< Requests. */
+
+	Requests _requests;
+	std::mutex _requestsLock;
+	std::condition_variable _requestsCond; // Signals queued requests.
+	std::condition_variable _respondedCond; // Signals answered requests.
+	Request::Ptr _current = nullptr; // Being handled by the polling thread.
+
+	/**< Static files. */
+
+	StaticFiles _staticFiles; // Most recently used first.
+	StaticFileIndex _staticFileIndex;
+	size_t _staticSize = 0;
+	std::mutex _staticLock;
+
 	/**< Callbacks. */
 
 	RequestedHandler _rspdHandler = nullptr;
 	mutable Mutex _rspdHandlerLock;
 
-	struct mg_connection* _pollingConn = nullptr;
-
 public:
 	WebCivetWeb();
 	virtual ~WebCivetWeb() override;
@@ -76,9 +175,13 @@ private:
 	void doOpen(unsigned short port);
 	void doClose(void);
 
-	void doPoll(void);
+	void doPoll(int timeoutMs);
 
 	bool onHttp(struct mg_connection* nc, void* cbdata);
+
+	void send(struct mg_connection* nc, const Request &req);
+	void serve(struct mg_connection* nc, const char* uri);
+	StaticFile::Ptr load(const std::string &path);
 };
 
 #endif /* BITTY_WEB_ENABLED */
@@ -9,10 +9,582 @@
 */
 
 #include "bytes.h"
+#include "datetime.h"
+#include "file_handle.h"
+#include "filesystem.h"
 #include "json.h"
 #include "platform.h"
 #include "web_curl.h"
 #include "../lib/jpath/jpath.hpp"
+#include <list>
+#if BITTY_MULTITHREAD_ENABLED
+#	include <condition_variable>
+#	include <set>
+#	include <thread>
+#endif /* BITTY_MULTITHREAD_ENABLED */
+
+/*
+** {===========================================================================
+** Fetch cache
+*/
+
+#if BITTY_WEB_ENABLED
+
+/**
+ * @brief Engine-wide HTTP response cache for GET fetches. Entries are keyed by
+ *   method and URL, and matched against the request headers named by "Vary".
+ *   Metadata and bodies are persisted under the writable directory; recently
+ *   used bodies are also kept in memory. Both tiers are bounded, and evicted
+ *   in LRU order.
+ */
+class FetchCurlCache : public NonCopyable {
+public:
+	enum Results {
+		MISS,
+		FRESH,
+		STALE
+	};
+
+private:
+	struct Entry {
+		typedef std::shared_ptr<Entry> Ptr;
+
+		std::string name; // Base file name.
+		std::string key;
+		std::string varyNames; // Lowercase, separated by ','.
+		std::string varyValues;
+		std::string etag;
+		std::string lastModified;
+		long long storedAt = 0;
+		long long maxAge = 0; // In seconds, 0 to always revalidate.
+		size_t size = 0;
+		std::shared_ptr<std::string> body = nullptr; // In memory, nullable.
+	};
+	typedef std::list<Entry::Ptr> Entries;
+	typedef std::map<std::string, Entries::iterator> Index;
+
+private:
+	std::string _dir;
+	Entries _entries; // Most recently used first.
+	Index _index; // By base file name.
+	size_t _diskSize = 0;
+	size_t _memorySize = 0;
+
+	Mutex _lock;
+
+public:
+	FetchCurlCache() {
+		_dir = Path::combine(Path::writableDirectory().c_str(), WEB_FETCH_CACHE_DIR);
+		if (!Path::existsDirectory(_dir.c_str()))
+			Path::touchDirectory(_dir.c_str());
+
+		load();
+	}
+
+	static FetchCurlCache &instance(void) {
+		static FetchCurlCache cache;
+
+		return cache;
+	}
+
+	/**
+	 * @brief Finds a cached response; the body is written to `body` only if
+	 *   it is still fresh, otherwise the validators are filled for a
+	 *   conditional request.
+	 */
+	Results find(const std::string &key, const Text::Array &headers, class Bytes* body, std::string &etag, std::string &lastModified) {
+		LockGuard<decltype(_lock)> guard(_lock);
+
+		Entry::Ptr entry = touch(key);
+		if (!entry)
+			return MISS;
+		if (vary(entry->varyNames, headers) != entry->varyValues)
+			return MISS;
+
+		std::shared_ptr<std::string> data = read(entry);
+		if (!data)
+			return MISS; // Dropped, cannot be revalidated without body.
+
+		const long long now = DateTime::utc();
+		if (now - entry->storedAt < entry->maxAge) {
+			body->clear();
+			body->writeBytes((const Byte*)data->c_str(), data->length());
+
+			return FRESH;
+		}
+
+		if (entry->etag.empty() && entry->lastModified.empty())
+			return MISS;
+
+		etag = entry->etag;
+		lastModified = entry->lastModified;
+
+		return STALE;
+	}
+	/**
+	 * @brief Refreshes an entry after a "304 Not Modified" response, and
+	 *   writes the cached body to `body`.
+	 */
+	bool revalidate(const std::string &key, const Text::Dictionary &rspHeaders, class Bytes* body) {
+		LockGuard<decltype(_lock)> guard(_lock);
+
+		Entry::Ptr entry = touch(key);
+		if (!entry)
+			return false;
+
+		std::shared_ptr<std::string> data = read(entry);
+		if (!data)
+			return false;
+
+		if (rspHeaders.find("cache-control") != rspHeaders.end()) { // Otherwise keep the stored one.
+			bool noStore = false;
+			control(rspHeaders, entry->maxAge, noStore);
+		}
+		entry->storedAt = DateTime::utc();
+		Text::Dictionary::const_iterator it = rspHeaders.find("etag");
+		if (it != rspHeaders.end())
+			entry->etag = it->second;
+		it = rspHeaders.find("last-modified");
+		if (it != rspHeaders.end())
+			entry->lastModified = it->second;
+		save(entry, nullptr);
+
+		body->clear();
+		body->writeBytes((const Byte*)data->c_str(), data->length());
+
+		return true;
+	}
+	/**
+	 * @brief Stores a "200 OK" response if it is allowed and useful to cache.
+	 */
+	void store(const std::string &key, const Text::Array &headers, const Text::Dictionary &rspHeaders, const class Bytes* body) {
+		LockGuard<decltype(_lock)> guard(_lock);
+
+		Entry::Ptr entry(new Entry());
+		entry->name = name(key);
+		entry->key = key;
+		bool noStore = false;
+		control(rspHeaders, entry->maxAge, noStore);
+		Text::Dictionary::const_iterator it = rspHeaders.find("etag");
+		if (it != rspHeaders.end())
+			entry->etag = it->second;
+		it = rspHeaders.find("last-modified");
+		if (it != rspHeaders.end())
+			entry->lastModified = it->second;
+		it = rspHeaders.find("vary");
+		if (it != rspHeaders.end()) {
+			const Text::Array names = Text::split(it->second, ", ");
+			for (std::string n : names) {
+				if (n == "*")
+					noStore = true;
+				Text::toLowerCase(n);
+				if (!entry->varyNames.empty())
+					entry->varyNames.push_back(',');
+				entry->varyNames += n;
+			}
+		}
+		const bool useful = entry->maxAge > 0 || !entry->etag.empty() || !entry->lastModified.empty();
+		if (noStore || !useful || body->count() > WEB_FETCH_CACHE_MEMORY_SIZE) {
+			remove(entry->name);
+
+			return;
+		}
+		entry->varyValues = vary(entry->varyNames, headers);
+		entry->storedAt = DateTime::utc();
+		entry->size = body->count();
+		entry->body = std::shared_ptr<std::string>(new std::string((const char*)body->pointer(), body->count()));
+
+		remove(entry->name);
+		if (!save(entry, entry->body.get()))
+			return;
+		_entries.push_front(entry);
+		_index[entry->name] = _entries.begin();
+		_diskSize += entry->size;
+		_memorySize += entry->size;
+
+		evict();
+	}
+
+private:
+	void load(void) {
+		DirectoryInfo::Ptr dirInfo = DirectoryInfo::make(_dir.c_str());
+		FileInfos::Ptr fileInfos = dirInfo->getFiles("*." WEB_FETCH_CACHE_META_EXT, false);
+		if (!fileInfos)
+			return;
+
+		for (int i = 0; i < fileInfos->count(); ++i) {
+			FileInfo::Ptr fileInfo = fileInfos->get(i);
+			File::Ptr file(File::create());
+			std::string str;
+			if (!file->open(fileInfo->fullPath().c_str(), Stream::READ))
+				continue;
+			file->readString(str);
+			file->close();
+
+			rapidjson::Document doc;
+			if (!Json::fromString(doc, str.c_str()))
+				continue;
+
+			Entry::Ptr entry(new Entry());
+			entry->name = fileInfo->fileName();
+			if (!Jpath::get(doc, entry->key, "key"))
+				continue;
+			Jpath::get(doc, entry->varyNames, "vary_names");
+			Jpath::get(doc, entry->varyValues, "vary_values");
+			Jpath::get(doc, entry->etag, "etag");
+			Jpath::get(doc, entry->lastModified, "last_modified");
+			Jpath::get(doc, entry->storedAt, "stored_at");
+			Jpath::get(doc, entry->maxAge, "max_age");
+			Jpath::get(doc, entry->size, "size");
+			if (_index.find(entry->name) != _index.end())
+				continue;
+
+			_entries.push_back(entry);
+			_index[entry->name] = --_entries.end();
+			_diskSize += entry->size;
+		}
+
+		evict();
+	}
+	bool save(Entry::Ptr entry, const std::string* body /* nullable */) {
+		if (body) {
+			const std::string path = Path::combine(_dir.c_str(), (entry->name + "." WEB_FETCH_CACHE_BODY_EXT).c_str());
+			File::Ptr file(File::create());
+			if (!file->open(path.c_str(), Stream::WRITE))
+				return false;
+			file->writeBytes((const Byte*)body->c_str(), body->length());
+			file->close();
+		}
+
+		rapidjson::Document doc;
+		Jpath::set(doc, doc, entry->key, "key");
+		Jpath::set(doc, doc, entry->varyNames, "vary_names");
+		Jpath::set(doc, doc, entry->varyValues, "vary_values");
+		Jpath::set(doc, doc, entry->etag, "etag");
+		Jpath::set(doc, doc, entry->lastModified, "last_modified");
+		Jpath::set(doc, doc, entry->storedAt, "stored_at");
+		Jpath::set(doc, doc, entry->maxAge, "max_age");
+		Jpath::set(doc, doc, (unsigned long long)entry->size, "size");
+		std::string str;
+		if (!Json::toString(doc, str, false))
+			return false;
+
+		const std::string path = Path::combine(_dir.c_str(), (entry->name + "." WEB_FETCH_CACHE_META_EXT).c_str());
+		File::Ptr file(File::create());
+		if (!file->open(path.c_str(), Stream::WRITE))
+			return false;
+		file->writeString(str);
+		file->close();
+
+		return true;
+	}
+	std::shared_ptr<std::string> read(Entry::Ptr entry) {
+		if (entry->body)
+			return entry->body;
+
+		const std::string path = Path::combine(_dir.c_str(), (entry->name + "." WEB_FETCH_CACHE_BODY_EXT).c_str());
+		File::Ptr file(File::create());
+		std::shared_ptr<std::string> data(new std::string());
+		if (!file->open(path.c_str(), Stream::READ)) {
+			remove(entry->name);
+
+			return nullptr;
+		}
+		file->readString(*data);
+		file->close();
+		if (data->length() != entry->size) {
+			remove(entry->name);
+
+			return nullptr;
+		}
+
+		entry->body = data;
+		_memorySize += entry->size;
+		evict();
+
+		return data;
+	}
+	Entry::Ptr touch(const std::string &key) {
+		Index::iterator it = _index.find(name(key));
+		if (it == _index.end())
+			return nullptr;
+
+		Entry::Ptr entry = *it->second;
+		if (entry->key != key)
+			return nullptr;
+
+		_entries.splice(_entries.begin(), _entries, it->second);
+
+		return entry;
+	}
+	void remove(const std::string &name) {
+		Index::iterator it = _index.find(name);
+		if (it == _index.end())
+			return;
+
+		Entry::Ptr entry = *it->second;
+		_diskSize -= entry->size;
+		if (entry->body)
+			_memorySize -= entry->size;
+		_entries.erase(it->second);
+		_index.erase(it);
+
+		Path::removeFile(Path::combine(_dir.c_str(), (name + "." WEB_FETCH_CACHE_META_EXT).c_str()).c_str(), false);
+		Path::removeFile(Path::combine(_dir.c_str(), (name + "." WEB_FETCH_CACHE_BODY_EXT).c_str()).c_str(), false);
+	}
+	void evict(void) {
+		// Drop bodies from memory, then entries from disk, least recently used
+		// first.
+		for (Entries::reverse_iterator it = _entries.rbegin(); it != _entries.rend() && _memorySize > WEB_FETCH_CACHE_MEMORY_SIZE; ++it) {
+			Entry::Ptr entry = *it;
+			if (!entry->body)
+				continue;
+
+			entry->body = nullptr;
+			_memorySize -= entry->size;
+		}
+		while (!_entries.empty() && _diskSize > WEB_FETCH_CACHE_DISK_SIZE)
+			remove(_entries.back()->name);
+	}
+
+	static std::string name(const std::string &key) {
+		UInt64 h = 14695981039346656037ull; // FNV-1a.
+		for (char ch : key) {
+			h ^= (Byte)ch;
+			h *= 1099511628211ull;
+		}
+
+		return Text::toHex(h, false);
+	}
+	static std::string vary(const std::string &names, const Text::Array &headers) {
+		if (names.empty())
+			return "";
+
+		const Text::Array names_ = Text::split(names, ",");
+		std::string result;
+		for (const std::string &n : names_) {
+			result += n;
+			result.push_back(':');
+			for (const std::string &h : headers) {
+				const std::string::size_type pos = h.find(':');
+				if (pos == std::string::npos)
+					continue;
+				std::string k = h.substr(0, pos);
+				Text::toLowerCase(k);
+				if (k == n)
+					result += Text::trim(h.substr(pos + 1));
+			}
+			result.push_back('\n');
+		}
+
+		return result;
+	}
+	static void control(const Text::Dictionary &rspHeaders, long long &maxAge, bool &noStore) {
+		maxAge = 0;
+		noStore = false;
+
+		Text::Dictionary::const_iterator it = rspHeaders.find("cache-control");
+		if (it == rspHeaders.end())
+			return;
+
+		std::string val = it->second;
+		Text::toLowerCase(val);
+		const Text::Array directives = Text::split(val, ", ");
+		for (const std::string &d : directives) {
+			if (d == "no-store") {
+				noStore = true;
+			} else if (d == "no-cache") {
+				maxAge = 0;
+
+				break;
+			} else if (Text::startsWith(d, "max-age=", false)) {
+				maxAge = std::max(std::atoll(d.c_str() + 8), 0ll);
+			}
+		}
+	}
+};
+
+#endif /* BITTY_WEB_ENABLED */
+
+/* ===========================================================================} */
+
+/*
+** {===========================================================================
+** Fetch service
+*/
+
+#if BITTY_WEB_ENABLED && BITTY_MULTITHREAD_ENABLED
+
+/**
+ * @brief Engine-wide service which drives all fetches with a single cURL multi
+ *   handle on the "WEB" thread. Connections are reused by the multi handle,
+ *   DNS results and TLS sessions are shared among easy handles.
+ */
+class FetchCurlService : public NonCopyable {
+private:
+	typedef std::vector<FetchCurl*> Requests;
+	typedef std::set<FetchCurl*> RequestSet;
+
+private:
+	CURLM* _multi = nullptr;
+	CURLSH* _share = nullptr;
+	std::mutex _shareLocks[CURL_LOCK_DATA_LAST];
+
+	std::thread _thread;
+	std::mutex _lock;
+	std::condition_variable _cond;
+	bool _quitting = false;
+	Requests _adding;
+	Requests _removing;
+	RequestSet _running; // By the service thread.
+
+public:
+	FetchCurlService() {
+		_share = curl_share_init();
+		curl_share_setopt(_share, CURLSHOPT_USERDATA, this);
+		curl_share_setopt(
+			_share, CURLSHOPT_LOCKFUNC,
+			+[] (CURL* /* handle */, curl_lock_data data, curl_lock_access /* access */, void* userptr) -> void {
+				FetchCurlService* self = (FetchCurlService*)userptr;
+				self->_shareLocks[data].lock();
+			}
+		);
+		curl_share_setopt(
+			_share, CURLSHOPT_UNLOCKFUNC,
+			+[] (CURL* /* handle */, curl_lock_data data, void* userptr) -> void {
+				FetchCurlService* self = (FetchCurlService*)userptr;
+				self->_shareLocks[data].unlock();
+			}
+		);
+		curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+		_multi = curl_multi_init();
+		curl_multi_setopt(_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, WEB_FETCH_MAX_CONNECTIONS);
+		curl_multi_setopt(_multi, CURLMOPT_MAX_HOST_CONNECTIONS, WEB_FETCH_MAX_HOST_CONNECTIONS);
+
+		_thread = std::thread(
+			[] (FetchCurlService* self) -> void {
+				self->run();
+			},
+			this
+		);
+	}
+	~FetchCurlService() {
+		{
+			std::unique_lock<std::mutex> guard(_lock);
+
+			_quitting = true;
+			curl_multi_wakeup(_multi);
+		}
+		if (_thread.joinable())
+			_thread.join();
+
+		curl_multi_cleanup(_multi);
+		_multi = nullptr;
+
+		curl_share_cleanup(_share);
+		_share = nullptr;
+	}
+
+	static FetchCurlService &instance(void) {
+		static FetchCurlService service;
+
+		return service;
+	}
+
+	void perform(FetchCurl* fetch) {
+		curl_easy_setopt(fetch->_curl, CURLOPT_SHARE, _share);
+		curl_easy_setopt(fetch->_curl, CURLOPT_PRIVATE, fetch);
+
+		std::unique_lock<std::mutex> guard(_lock);
+
+		_adding.push_back(fetch);
+		curl_multi_wakeup(_multi);
+	}
+	/**
+	 * @brief Removes a fetch, and waits until the service thread has released
+	 *   it; must not be called with the lock of the fetch held.
+	 */
+	void cancel(FetchCurl* fetch) {
+		std::unique_lock<std::mutex> guard(_lock);
+
+		Requests::iterator it = std::find(_adding.begin(), _adding.end(), fetch);
+		if (it != _adding.end()) {
+			_adding.erase(it);
+
+			return;
+		}
+
+		_removing.push_back(fetch);
+		curl_multi_wakeup(_multi);
+		_cond.wait(
+			guard,
+			[&] (void) -> bool {
+				return std::find(_removing.begin(), _removing.end(), fetch) == _removing.end();
+			}
+		);
+	}
+
+private:
+	void run(void) {
+		Platform::threadName("WEB");
+
+		Platform::locale("C");
+
+		for (; ; ) {
+			// Apply requests.
+			{
+				std::unique_lock<std::mutex> guard(_lock);
+
+				if (_quitting)
+					break;
+
+				for (FetchCurl* fetch : _adding) {
+					curl_multi_add_handle(_multi, fetch->_curl);
+					_running.insert(fetch);
+				}
+				_adding.clear();
+				for (FetchCurl* fetch : _removing) {
+					if (_running.erase(fetch))
+						curl_multi_remove_handle(_multi, fetch->_curl);
+				}
+				_removing.clear();
+				_cond.notify_all();
+			}
+
+			// Transfer.
+			int running = 0;
+			curl_multi_perform(_multi, &running);
+
+			int left = 0;
+			while (CURLMsg* msg = curl_multi_info_read(_multi, &left)) {
+				if (msg->msg != CURLMSG_DONE)
+					continue;
+
+				CURL* curl = msg->easy_handle;
+				const CURLcode res = msg->data.result;
+				FetchCurl* fetch = nullptr;
+				curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char**)&fetch);
+				curl_multi_remove_handle(_multi, curl);
+				_running.erase(fetch);
+
+				fetch->finish(res);
+			}
+
+			// Wait for activities or requests.
+			curl_multi_poll(_multi, nullptr, 0, WEB_FETCH_POLL_TIMEOUT_MS, nullptr);
+		}
+
+		for (FetchCurl* fetch : _running)
+			curl_multi_remove_handle(_multi, fetch->_curl);
+		_running.clear();
+	}
+};
+
+#endif /* BITTY_WEB_ENABLED && BITTY_MULTITHREAD_ENABLED */
+
+/* ===========================================================================} */
 
 /*
 ** {===========================================================================
@@ -34,6 +606,8 @@ FetchCurl::FetchCurl() {
 }
 
 FetchCurl::~FetchCurl() {
+	cancel();
+
 	LockGuard<decltype(_lock)> guard(_lock);
 
 	reset();
@@ -60,6 +634,8 @@ bool FetchCurl::open(void) {
 }
 
 bool FetchCurl::close(void) {
+	cancel();
+
 	LockGuard<decltype(_lock)> guard(_lock);
 
 	reset();
@@ -69,6 +645,7 @@ bool FetchCurl::close(void) {
 
 	_rspHandler = nullptr;
 	_errHandler = nullptr;
+	_prgHandler = nullptr;
 
 	curl_easy_cleanup(_curl);
 	_curl = curl_easy_init();
@@ -97,6 +674,7 @@ void FetchCurl::url(const char* url) {
 
 	LockGuard<decltype(_lock)> guard(_lock);
 
+	_url = url;
 	curl_easy_setopt(_curl, CURLOPT_URL, url);
 
 	if (Text::startsWith(url, "https://", true)) {
@@ -178,6 +756,7 @@ void FetchCurl::headers(const Text::Array &headers) {
 	for (const std::string &h : _headers)
 		_headersOpt = curl_slist_append(_headersOpt, h.c_str());
 	curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, _headersOpt);
+	_conditional = false;
 }
 
 void FetchCurl::method(const char* method) {
@@ -186,6 +765,8 @@ void FetchCurl::method(const char* method) {
 
 	LockGuard<decltype(_lock)> guard(_lock);
 
+	_method = method ? method : "";
+	Text::toUpperCase(_method);
 	if (method)
 		curl_easy_setopt(_curl, CURLOPT_CUSTOMREQUEST, method);
 	else
@@ -198,6 +779,7 @@ void FetchCurl::body(const char* body) {
 
 	LockGuard<decltype(_lock)> guard(_lock);
 
+	_posting = true;
 	if (body)
 		curl_easy_setopt(_curl, CURLOPT_POSTFIELDS, body);
 	else
@@ -214,14 +796,49 @@ void FetchCurl::timeout(long t, long conn) {
 	_connTimeout = conn;
 }
 
+void FetchCurl::output(const char* path) {
+	if (_state == BUSY)
+		return;
+
+	LockGuard<decltype(_lock)> guard(_lock);
+
+	_outputPath = path ? path : "";
+	_outputBytes = nullptr;
+}
+
+void FetchCurl::output(const std::shared_ptr<class Bytes> &bytes) {
+	if (_state == BUSY)
+		return;
+
+	LockGuard<decltype(_lock)> guard(_lock);
+
+	_outputPath.clear();
+	_outputBytes = bytes;
+}
+
 bool FetchCurl::perform(void) {
 	if (_state == BUSY)
 		return false;
 
 	LockGuard<decltype(_lock)> guard(_lock);
 
+	if (!_outputPath.empty()) {
+		_outputFile = File::create();
+		if (!_outputFile->open(_outputPath.c_str(), Stream::WRITE)) {
+			File::destroy(_outputFile);
+			_outputFile = nullptr;
+
+			return false;
+		}
+	}
+
 	curl_easy_setopt(_curl, CURLOPT_WRITEDATA, this);
 	curl_easy_setopt(_curl, CURLOPT_WRITEFUNCTION, receive);
+	curl_easy_setopt(_curl, CURLOPT_HEADERDATA, this);
+	curl_easy_setopt(_curl, CURLOPT_HEADERFUNCTION, header);
+	curl_easy_setopt(_curl, CURLOPT_XFERINFODATA, this);
+	curl_easy_setopt(_curl, CURLOPT_XFERINFOFUNCTION, progress);
+	curl_easy_setopt(_curl, CURLOPT_NOPROGRESS, 0L);
 
 	curl_easy_setopt(_curl, CURLOPT_TIMEOUT, _timeout);
 	curl_easy_setopt(_curl, CURLOPT_CONNECTTIMEOUT, _connTimeout);
@@ -233,31 +850,59 @@ bool FetchCurl::perform(void) {
 	_response->clear();
 	_error.clear();
 
-#if BITTY_MULTITHREAD_ENABLED
-	auto proc = [] (FetchCurl* self, CURL* curl) -> bool {
-		LockGuard<decltype(self->_lock)> guard(self->_lock);
-
-		Platform::threadName("WEB");
-
-		Platform::locale("C");
-
-		CURLcode res = curl_easy_perform(curl);
-		if (res != CURLE_OK) {
-			const char* err = curl_easy_strerror(res);
-			fprintf(stderr, "CURL failed: %s\n", err);
-
-			self->_error = err;
-
-			self->_state = RESPONDED;
-
-			return false;
+	_received = 0;
+	_total = 0;
+	_canceled = false;
+	_reported = -1;
+
+	_cacheKey.clear();
+	_responseHeaders.clear();
+	if (_conditional) { // Drop the validators of the last request.
+		if (_headersOpt) {
+			curl_slist_free_all(_headersOpt);
+			_headersOpt = nullptr;
 		}
+		for (const std::string &h : _headers)
+			_headersOpt = curl_slist_append(_headersOpt, h.c_str());
+		curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, _headersOpt);
+		_conditional = false;
+	}
+	if (cacheable()) {
+		const std::string key = "GET " + _url;
+		std::string etag, lastModified;
+		switch (FetchCurlCache::instance().find(key, _headers, _response, etag, lastModified)) {
+		case FetchCurlCache::FRESH:
+			_received = (long long)_response->count();
+			_total = _received;
+			_state = RESPONDED; // Served from cache without touching the network.
+
+			return true;
+		case FetchCurlCache::STALE: {
+				// Revalidate with a conditional request.
+				if (_headersOpt) {
+					curl_slist_free_all(_headersOpt);
+					_headersOpt = nullptr;
+				}
+				for (const std::string &h : _headers)
+					_headersOpt = curl_slist_append(_headersOpt, h.c_str());
+				if (!etag.empty())
+					_headersOpt = curl_slist_append(_headersOpt, ("If-None-Match: " + etag).c_str());
+				if (!lastModified.empty())
+					_headersOpt = curl_slist_append(_headersOpt, ("If-Modified-Since: " + lastModified).c_str());
+				curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, _headersOpt);
+				_conditional = true;
+			}
+
+			break;
+		case FetchCurlCache::MISS: // Fall through.
+		default: // Do nothing.
+			break;
+		}
+		_cacheKey = key;
+	}
 
-		self->_state = RESPONDED;
-
-		return true;
-	};
-	_thread = std::thread(proc, this, _curl);
+#if BITTY_MULTITHREAD_ENABLED
+	FetchCurlService::instance().perform(this);
 #endif /* BITTY_MULTITHREAD_ENABLED */
 
 	return true;
@@ -276,6 +921,7 @@ void FetchCurl::clear(void) {
 
 	_rspHandler = nullptr;
 	_errHandler = nullptr;
+	_prgHandler = nullptr;
 
 	curl_easy_reset(_curl);
 }
@@ -283,19 +929,30 @@ void FetchCurl::clear(void) {
 bool FetchCurl::update(double) {
 	if (_state == IDLE)
 		return true;
-	if (_state == BUSY)
-		return true;
+
+	report();
 
 	LockGuard<decltype(_lock)> guard(_lock);
 
+	drain();
+
+	if (_state == BUSY)
+		return true;
+
 	assert(_state == RESPONDED);
-#if BITTY_MULTITHREAD_ENABLED
-	if (_thread.joinable())
-		_thread.join();
-#endif /* BITTY_MULTITHREAD_ENABLED */
+	const bool streamed = streaming(); // Before closing the output file.
+	if (_outputFile) {
+		_outputFile->close();
+		File::destroy(_outputFile);
+		_outputFile = nullptr;
+	}
 	if (_error.empty()) {
-		if (!_rspHandler.empty())
-			_rspHandler(&_rspHandler, _response->pointer(), _response->count());
+		if (!_rspHandler.empty()) {
+			if (streamed)
+				_rspHandler(&_rspHandler, nullptr, (size_t)(long long)_received);
+			else
+				_rspHandler(&_rspHandler, _response->pointer(), _response->count());
+		}
 
 		_state = IDLE;
 	} else {
@@ -316,6 +973,10 @@ const Fetch::ErrorHandler &FetchCurl::errorCallback(void) const {
 	return _errHandler;
 }
 
+const Fetch::ProgressHandler &FetchCurl::progressCallback(void) const {
+	return _prgHandler;
+}
+
 void FetchCurl::callback(const RespondedHandler &cb) {
 	_rspHandler = cb;
 }
@@ -324,38 +985,157 @@ void FetchCurl::callback(const ErrorHandler &cb) {
 	_errHandler = cb;
 }
 
+void FetchCurl::callback(const ProgressHandler &cb) {
+	_prgHandler = cb;
+}
+
 void FetchCurl::reset(void) {
 	LockGuard<decltype(_lock)> guard(_lock);
 
-#if BITTY_MULTITHREAD_ENABLED
-	if (_thread.joinable())
-		_thread.join();
-#endif /* BITTY_MULTITHREAD_ENABLED */
-
 	_state = IDLE;
 
+	_url.clear();
+	_method.clear();
+	_posting = false;
 	_headers.clear();
 	if (_headersOpt) {
 		curl_slist_free_all(_headersOpt);
 		_headersOpt = nullptr;
 	}
+	_conditional = false;
 	_timeout = WEB_FETCH_TIMEOUT_SECONDS;
 	_connTimeout = WEB_FETCH_CONNECTION_TIMEOUT_SECONDS;
 	_responseHint = STRING;
+
+	_outputPath.clear();
+	if (_outputFile) {
+		_outputFile->close();
+		File::destroy(_outputFile);
+		_outputFile = nullptr;
+	}
+	_outputBytes = nullptr;
+}
+
+void FetchCurl::cancel(void) {
+#if BITTY_MULTITHREAD_ENABLED
+	if (_state == BUSY)
+		FetchCurlService::instance().cancel(this);
+#endif /* BITTY_MULTITHREAD_ENABLED */
+}
+
+void FetchCurl::finish(CURLcode res) {
+	LockGuard<decltype(_lock)> guard(_lock);
+
+	if (res != CURLE_OK) {
+		const char* err = curl_easy_strerror(res);
+		fprintf(stderr, "CURL failed: %s\n", err);
+
+		_error = err;
+	} else if (!_cacheKey.empty()) {
+		long status = 0;
+		curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, &status);
+		if (status == 304) {
+			if (!FetchCurlCache::instance().revalidate(_cacheKey, _responseHeaders, _response))
+				_error = "Cached response is missing.";
+		} else if (status == 200) {
+			FetchCurlCache::instance().store(_cacheKey, _headers, _responseHeaders, _response);
+		}
+	}
+
+	_state = RESPONDED;
+}
+
+void FetchCurl::drain(void) {
+	// Move the staged chunks to the output `Bytes` on the updating thread, so
+	// that only data received during one frame is held in the staging buffer.
+	if (!_outputBytes || _response->empty())
+		return;
+
+	_outputBytes->writeBytes(_response->pointer(), _response->count());
+	_response->clear();
+}
+
+void FetchCurl::report(void) {
+	if (_prgHandler.empty())
+		return;
+
+	const long long received = _received;
+	if (received == _reported)
+		return;
+
+	_reported = received;
+	if (!_prgHandler(&_prgHandler, received, _total))
+		_canceled = true;
+}
+
+bool FetchCurl::streaming(void) const {
+	return !!_outputFile || !!_outputBytes;
+}
+
+bool FetchCurl::cacheable(void) const {
+	if (streaming() || _posting)
+		return false;
+	if (!_method.empty() && _method != "GET")
+		return false;
+	if (!Text::startsWith(_url, "http://", true) && !Text::startsWith(_url, "https://", true))
+		return false;
+
+	return true;
 }
 
 size_t FetchCurl::receive(void* ptr, size_t size, size_t nmemb, void* stream) {
 	FetchCurl* self = (FetchCurl*)stream;
 
+	if (self->_canceled)
+		return 0;
+
 	LockGuard<decltype(self->_lock)> guard(self->_lock);
 
 	size_t len = size * nmemb;
-	if (ptr && len)
-		self->_response->writeBytes((Byte*)ptr, len);
+	if (ptr && len) {
+		if (self->_outputFile) {
+			if (self->_outputFile->writeBytes((Byte*)ptr, len) != (int)len)
+				return 0; // Abort on write failure.
+		} else {
+			self->_response->writeBytes((Byte*)ptr, len);
+		}
+		self->_received = self->_received + (long long)len; // Written by this thread only.
+	}
 
 	return size * nmemb;
 }
 
+size_t FetchCurl::header(char* ptr, size_t size, size_t nmemb, void* stream) {
+	FetchCurl* self = (FetchCurl*)stream;
+
+	LockGuard<decltype(self->_lock)> guard(self->_lock);
+
+	const size_t len = size * nmemb;
+	const std::string line(ptr, len);
+	if (Text::startsWith(line, "HTTP/", false)) {
+		self->_responseHeaders.clear(); // A new response, i.e. after redirection.
+
+		return len;
+	}
+	const std::string::size_type pos = line.find(':');
+	if (pos == std::string::npos)
+		return len;
+
+	std::string key = Text::trim(line.substr(0, pos));
+	Text::toLowerCase(key);
+	self->_responseHeaders[key] = Text::trim(line.substr(pos + 1));
+
+	return len;
+}
+
+int FetchCurl::progress(void* clientp, curl_off_t dltotal, curl_off_t /* dlnow */, curl_off_t /* ultotal */, curl_off_t /* ulnow */) {
+	FetchCurl* self = (FetchCurl*)clientp;
+
+	self->_total = (long long)dltotal;
+
+	return self->_canceled ? 1 : 0; // Non-zero to abort the transfer.
+}
+
 #endif /* BITTY_WEB_ENABLED */
 
 /* ===========================================================================} */
@@ -17,9 +17,6 @@
 #		include <curl/curl.h>
 #	endif /* BITTY_OS_HTML */
 #endif /* BITTY_WEB_ENABLED */
-#if BITTY_MULTITHREAD_ENABLED
-#	include <thread>
-#endif /* BITTY_MULTITHREAD_ENABLED */
 
 /*
 ** {===========================================================================
@@ -32,6 +29,31 @@
 #ifndef WEB_FETCH_CONNECTION_TIMEOUT_SECONDS
 #	define WEB_FETCH_CONNECTION_TIMEOUT_SECONDS 10l
 #endif /* WEB_FETCH_CONNECTION_TIMEOUT_SECONDS */
+#ifndef WEB_FETCH_MAX_CONNECTIONS
+#	define WEB_FETCH_MAX_CONNECTIONS 8l
+#endif /* WEB_FETCH_MAX_CONNECTIONS */
+#ifndef WEB_FETCH_MAX_HOST_CONNECTIONS
+#	define WEB_FETCH_MAX_HOST_CONNECTIONS 4l
+#endif /* WEB_FETCH_MAX_HOST_CONNECTIONS */
+#ifndef WEB_FETCH_POLL_TIMEOUT_MS
+#	define WEB_FETCH_POLL_TIMEOUT_MS 1000
+#endif /* WEB_FETCH_POLL_TIMEOUT_MS */
+
+#ifndef WEB_FETCH_CACHE_DIR
+#	define WEB_FETCH_CACHE_DIR "fetch_cache"
+#endif /* WEB_FETCH_CACHE_DIR */
+#ifndef WEB_FETCH_CACHE_META_EXT
+#	define WEB_FETCH_CACHE_META_EXT "meta"
+#endif /* WEB_FETCH_CACHE_META_EXT */
+#ifndef WEB_FETCH_CACHE_BODY_EXT
+#	define WEB_FETCH_CACHE_BODY_EXT "body"
+#endif /* WEB_FETCH_CACHE_BODY_EXT */
+#ifndef WEB_FETCH_CACHE_DISK_SIZE
+#	define WEB_FETCH_CACHE_DISK_SIZE (64 * 1024 * 1024)
+#endif /* WEB_FETCH_CACHE_DISK_SIZE */
+#ifndef WEB_FETCH_CACHE_MEMORY_SIZE
+#	define WEB_FETCH_CACHE_MEMORY_SIZE (4 * 1024 * 1024)
+#endif /* WEB_FETCH_CACHE_MEMORY_SIZE */
 
 /* ===========================================================================} */
 
@@ -43,6 +65,8 @@
 #if BITTY_WEB_ENABLED
 
 class FetchCurl : public Fetch {
+	friend class FetchCurlService;
+
 private:
 	enum States {
 		IDLE,
@@ -57,6 +81,9 @@ private:
 
 	/**< Options. */
 
+	std::string _url;
+	std::string _method;
+	bool _posting = false;
 	Text::Array _headers;
 	struct curl_slist* _headersOpt = nullptr;
 	long _timeout = WEB_FETCH_TIMEOUT_SECONDS;
@@ -68,6 +95,25 @@ private:
 
 	CURL* _curl = nullptr;
 
+	/**< Streaming. */
+
+	std::string _outputPath;
+	class File* _outputFile = nullptr;
+	std::shared_ptr<class Bytes> _outputBytes = nullptr;
+
+	/**< Progress. */
+
+	Atomic<long long> _received { 0 };
+	Atomic<long long> _total { 0 };
+	Atomic<bool> _canceled { false };
+	long long _reported = -1;
+
+	/**< Caching. */
+
+	std::string _cacheKey;
+	Text::Dictionary _responseHeaders;
+	bool _conditional = false; // Whether the header list carries validators.
+
 	/**< Callbacks. */
 
 	class Bytes* _response = nullptr;
@@ -75,12 +121,10 @@ private:
 
 	RespondedHandler _rspHandler;
 	ErrorHandler _errHandler;
+	ProgressHandler _prgHandler;
 
 	/**< Threading. */
 
-#if BITTY_MULTITHREAD_ENABLED
-	std::thread _thread;
-#endif /* BITTY_MULTITHREAD_ENABLED */
 	mutable RecursiveMutex _lock;
 
 public:
@@ -101,6 +145,8 @@ public:
 	virtual void method(const char* method) override;
 	virtual void body(const char* body) override;
 	virtual void timeout(long t, long conn) override;
+	virtual void output(const char* path) override;
+	virtual void output(const std::shared_ptr<class Bytes> &bytes) override;
 
 	virtual bool perform(void) override;
 
@@ -110,13 +156,23 @@ public:
 
 	virtual const RespondedHandler &respondedCallback(void) const override;
 	virtual const ErrorHandler &errorCallback(void) const override;
+	virtual const ProgressHandler &progressCallback(void) const override;
 	virtual void callback(const RespondedHandler &cb) override;
 	virtual void callback(const ErrorHandler &cb) override;
+	virtual void callback(const ProgressHandler &cb) override;
 
 private:
 	void reset(void);
+	void cancel(void);
+	void finish(CURLcode res);
+	void drain(void);
+	void report(void);
+	bool streaming(void) const;
+	bool cacheable(void) const;
 
 	static size_t receive(void* ptr, size_t size, size_t nmemb, void* stream);
+	static size_t header(char* ptr, size_t size, size_t nmemb, void* stream);
+	static int progress(void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
 };
 
 #endif /* BITTY_WEB_ENABLED */
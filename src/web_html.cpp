@@ -9,6 +9,7 @@
 */
 
 #include "bytes.h"
+#include "file_handle.h"
 #include "json.h"
 #include "platform.h"
 #include "web_html.h"
@@ -225,6 +226,7 @@ bool FetchHtml::close(void) {
 
 	_rspHandler = nullptr;
 	_errHandler = nullptr;
+	_prgHandler = nullptr;
 
 	return true;
 }
@@ -308,6 +310,16 @@ void FetchHtml::timeout(long, long) {
 	// Do nothing.
 }
 
+void FetchHtml::output(const char* path) {
+	_outputPath = path ? path : "";
+	_outputBytes = nullptr;
+}
+
+void FetchHtml::output(const std::shared_ptr<class Bytes> &bytes) {
+	_outputPath.clear();
+	_outputBytes = bytes;
+}
+
 bool FetchHtml::perform(void) {
 	webFetchPerform(_id, _url.c_str(), _options.c_str());
 
@@ -335,9 +347,32 @@ bool FetchHtml::update(double) {
 	if (err)
 		_error.assign(err);
 
+	// The browser delivers the body at once, so streaming degrades to writing
+	// it out on completion.
+	if (_error.empty() && !_prgHandler.empty()) {
+		if (!_prgHandler(&_prgHandler, (long long)_response.length(), (long long)_response.length()))
+			_error = "Canceled.";
+	}
+	if (_error.empty() && !_outputPath.empty()) {
+		File::Ptr file(File::create());
+		if (file->open(_outputPath.c_str(), Stream::WRITE)) {
+			file->writeBytes((const Byte*)_response.c_str(), _response.length());
+			file->close();
+		} else {
+			_error = "Cannot write to output file.";
+		}
+	}
+	if (_error.empty() && _outputBytes) {
+		_outputBytes->writeBytes((const Byte*)_response.c_str(), _response.length());
+	}
+
 	if (_error.empty()) {
-		if (!_rspHandler.empty())
-			_rspHandler(&_rspHandler, (Byte*)_response.c_str(), _response.length());
+		if (!_rspHandler.empty()) {
+			if (!_outputPath.empty() || _outputBytes)
+				_rspHandler(&_rspHandler, nullptr, _response.length());
+			else
+				_rspHandler(&_rspHandler, (Byte*)_response.c_str(), _response.length());
+		}
 	} else {
 		if (!_errHandler.empty())
 			_errHandler(&_errHandler, _error.c_str());
@@ -357,6 +392,10 @@ const Fetch::ErrorHandler &FetchHtml::errorCallback(void) const {
 	return _errHandler;
 }
 
+const Fetch::ProgressHandler &FetchHtml::progressCallback(void) const {
+	return _prgHandler;
+}
+
 void FetchHtml::callback(const RespondedHandler &cb) {
 	_rspHandler = cb;
 }
@@ -365,12 +404,19 @@ void FetchHtml::callback(const ErrorHandler &cb) {
 	_errHandler = cb;
 }
 
+void FetchHtml::callback(const ProgressHandler &cb) {
+	_prgHandler = cb;
+}
+
 void FetchHtml::reset(void) {
 	_options.clear();
 	_headers.clear();
 	_method.clear();
 	_body.clear();
 	_responseHint = STRING;
+
+	_outputPath.clear();
+	_outputBytes = nullptr;
 }
 
 #endif /* BITTY_WEB_ENABLED */
@@ -35,6 +35,11 @@ private:
 	std::string _body;
 	DataTypes _responseHint = STRING;
 
+	/**< Streaming. */
+
+	std::string _outputPath;
+	std::shared_ptr<class Bytes> _outputBytes = nullptr;
+
 	/**< Callbacks. */
 
 	std::string _response;
@@ -42,6 +47,7 @@ private:
 
 	RespondedHandler _rspHandler;
 	ErrorHandler _errHandler;
+	ProgressHandler _prgHandler;
 
 public:
 	FetchHtml();
@@ -61,6 +67,8 @@ public:
 	virtual void method(const char* method) override;
 	virtual void body(const char* body) override;
 	virtual void timeout(long t, long conn) override;
+	virtual void output(const char* path) override;
+	virtual void output(const std::shared_ptr<class Bytes> &bytes) override;
 
 	virtual bool perform(void) override;
 
@@ -70,8 +78,10 @@ public:
 
 	virtual const RespondedHandler &respondedCallback(void) const override;
 	virtual const ErrorHandler &errorCallback(void) const override;
+	virtual const ProgressHandler &progressCallback(void) const override;
 	virtual void callback(const RespondedHandler &cb) override;
 	virtual void callback(const ErrorHandler &cb) override;
+	virtual void callback(const ProgressHandler &cb) override;
 
 private:
 	void reset(void);
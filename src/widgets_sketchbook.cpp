@@ -88,7 +88,7 @@ void PreferencesPopupBox::update(void) {
 
 					SameLine();
 
-					const char* items[] = { _theme->generic_Text().c_str(), _theme->generic_Binary().c_str() };
+					const char* items[] = { _theme->generic_Text().c_str(), _theme->generic_Binary().c_str(), _theme->generic_Packed().c_str() };
 					int pref = (int)_settingsShadow.projectPreference;
 					SetNextItemWidth(GetContentRegionAvail().x);
 					if (Combo("", &pref, items, BITTY_COUNTOF(items)))
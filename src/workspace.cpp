@@ -2440,6 +2440,11 @@ void Workspace::debug(class Window* /* wnd */, class Renderer* rnd, const class
 			ImGui::Text("   CPU FPS: %u", exec->fps());
 			ImGui::Text("   GPU FPS: %u", fps);
 			ImGui::Text("  COMMANDS: %u", primitives->commands());
+			exec->getStatistics(
+				[] (const char* key, const char* val) -> void {
+					ImGui::Text("%10s: %s", key, val);
+				}
+			);
 
 			debugWidth(ImGui::GetWindowSize().x);
 		}